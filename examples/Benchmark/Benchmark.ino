@@ -0,0 +1,144 @@
+/**
+ * Benchmark.ino - Soak test for ESP32-WebCommunication library
+ *
+ * This example drives the dashboard as hard as a real application would
+ * over hours: fast value updates, batched updates, log messages and machine
+ * state changes. Every few seconds it prints the update counters, buffer
+ * pool usage and heap statistics. Leave it running with one or more browsers
+ * connected; a healthy build shows a flat minimum free heap, a constant
+ * largest free block and no pool fallbacks.
+ *
+ * Hardware:
+ * - ESP32 board
+ */
+
+#include <Arduino.h>
+#include <WebDashboard.h>
+
+// WiFi credentials
+const char* ssid = "YourWiFiSSID";          // Replace with your WiFi SSID
+const char* password = "YourWiFiPassword";  // Replace with your WiFi password
+
+// How often the statistics are printed (ms)
+const uint32_t reportInterval = 5000;
+
+// Dashboard instance
+WebDashboard dashboard;
+
+SliderHandle counterSlider;
+ToggleHandle blinkToggle;
+TextInputHandle levelText;
+TextInputHandle messageText;
+
+uint32_t iteration = 0;
+uint32_t lastReport = 0;
+uint32_t startTime = 0;
+
+void printStats() {
+  const DashboardStats& stats = dashboard.getStats();
+
+  Serial.printf("[%6lus] sent=%lu suppressed=%lu inputs=%lu coalesced=%lu\n",
+                (unsigned long)((millis() - startTime) / 1000),
+                (unsigned long)stats.updatesSent,
+                (unsigned long)stats.updatesSuppressed,
+                (unsigned long)stats.inputsReceived,
+                (unsigned long)stats.inputsCoalesced);
+  Serial.printf("  pool: allocations=%lu fallbacks=%lu inUse=%u highWater=%u\n",
+                (unsigned long)stats.poolAllocations,
+                (unsigned long)stats.poolFallbacks, stats.poolInUse,
+                stats.poolHighWater);
+  Serial.printf("  sockets: frames=%lu copied=%lu bytes (%lu per frame)\n",
+                (unsigned long)stats.socketFrames,
+                (unsigned long)stats.socketBytesCopied,
+                (unsigned long)(stats.socketFrames > 0
+                                    ? stats.socketBytesCopied /
+                                          stats.socketFrames
+                                    : 0));
+  Serial.printf(
+      "  heap: free=%lu minFree=%lu largestBlock=%lu fragmentation=%u%%\n",
+      (unsigned long)stats.freeHeap, (unsigned long)stats.minFreeHeap,
+      (unsigned long)stats.largestFreeBlock, stats.fragmentation);
+  Serial.printf("  components: table=%lu index=%lu strings=%lu fragments=%lu\n",
+                (unsigned long)stats.componentBytes,
+                (unsigned long)stats.indexBytes,
+                (unsigned long)stats.stringBytes,
+                (unsigned long)stats.fragmentBytes);
+
+  static const char* classes[PRIORITY_COUNT] = {"critical", "control",
+                                                "telemetry", "bulk"};
+  for (int c = 0; c < PRIORITY_COUNT; c++) {
+    const DashboardQueueStats& queue = stats.queues[c];
+    Serial.printf(
+        "  %s: sent=%lu depth=%u highWater=%u coalesced=%lu dropped=%lu "
+        "latency=%lu/%lums\n",
+        classes[c], (unsigned long)queue.sent, queue.depth, queue.highWater,
+        (unsigned long)queue.coalesced, (unsigned long)queue.dropped,
+        (unsigned long)queue.averageLatency, (unsigned long)queue.maxLatency);
+  }
+  Serial.printf(
+      "  events: viewers=%u published=%lu delivered=%lu shared=%lu "
+      "dropped=%lu\n",
+      stats.events.viewers, (unsigned long)stats.events.published,
+      (unsigned long)stats.events.delivered,
+      (unsigned long)stats.events.copiesSaved,
+      (unsigned long)stats.events.viewersDropped);
+}
+
+void setup() {
+  Serial.begin(115200);
+  Serial.println("ESP32 Web Dashboard Benchmark");
+
+  if (!dashboard.begin(ssid, password, "Dashboard Benchmark")) {
+    Serial.println("Failed to start dashboard");
+    return;
+  }
+  Serial.printf("Dashboard available at: http://%s\n",
+                dashboard.getIPAddress().c_str());
+
+  counterSlider = dashboard.addSlider("counter", "Counter", 0, 1000, 0);
+  blinkToggle = dashboard.addToggle("blink", "Blink", false, NULL);
+  levelText = dashboard.addTextInput("level", "Level", "0");
+  messageText = dashboard.addTextInput("message", "Message", "");
+
+  startTime = millis();
+  lastReport = startTime;
+}
+
+void loop() {
+  dashboard.update();
+  iteration++;
+
+  // Single updates every pass
+  dashboard.updateValue(counterSlider, (int)(iteration % 1001));
+  dashboard.updateValue(levelText, sinf(iteration / 50.0f) * 100.0f, 2);
+
+  // Variable-length strings exercise the larger size classes
+  if (iteration % 10 == 0) {
+    char message[96];
+    int length = snprintf(message, sizeof(message), "Iteration %lu ",
+                          (unsigned long)iteration);
+    int padding = min((int)(iteration % 64), (int)sizeof(message) - length - 1);
+    memset(message + length, '#', padding);
+    message[length + padding] = '\0';
+    dashboard.updateValue(messageText, message);
+  }
+
+  // A batch of everything
+  if (iteration % 25 == 0) {
+    DashboardBatch batch(dashboard);
+    dashboard.updateValue(blinkToggle, (iteration / 25) % 2 == 0);
+    dashboard.updateValue(counterSlider, 0);
+    dashboard.setMachineState(iteration % 50 == 0 ? "RUNNING" : "IDLE");
+  }
+
+  if (iteration % 100 == 0) {
+    dashboard.logf(LOG_INFO, "Soak iteration %lu", (unsigned long)iteration);
+  }
+
+  if (millis() - lastReport >= reportInterval) {
+    lastReport = millis();
+    printStats();
+  }
+
+  delay(5);
+}
@@ -0,0 +1,106 @@
+/**
+ * MessageBenchmark.ino - Inbound message parsing test for
+ * ESP32-WebCommunication
+ *
+ * This example parses the messages the dashboard page sends, once with a
+ * heap-backed ArduinoJson document (how they used to be read) and once with
+ * the in-place DashboardMessage parser the dashboard uses now, and prints
+ * messages per second and heap allocations per message for each. No WiFi
+ * connection is needed.
+ *
+ * Hardware:
+ * - ESP32 board
+ */
+
+#include <Arduino.h>
+#include <ArduinoJson.h>
+#include <WebDashboard.h>
+
+// Messages as the page sends them
+const char* messages[] = {
+    "{\"type\":\"slider_change\",\"id\":\"motor_speed\",\"value\":42}",
+    "{\"type\":\"toggle_change\",\"id\":\"pump\",\"value\":true}",
+    "{\"type\":\"text_input_change\",\"id\":\"label\",\"value\":\"Line 2\"}",
+    "{\"type\":\"select_change\",\"id\":\"mode\",\"value\":\"Auto\"}",
+    "{\"type\":\"button_press\",\"id\":\"start\"}",
+    "{\"type\":\"subscribe\",\"groups\":4}",
+};
+const int messageCount = sizeof(messages) / sizeof(messages[0]);
+const int rounds = 2000;
+
+// Counts the allocations ArduinoJson makes from the heap
+class CountingAllocator : public ArduinoJson::Allocator {
+ public:
+  uint32_t allocations = 0;
+
+  void* allocate(size_t size) override {
+    allocations++;
+    return malloc(size);
+  }
+  void deallocate(void* ptr) override { free(ptr); }
+  void* reallocate(void* ptr, size_t newSize) override {
+    allocations++;
+    return realloc(ptr, newSize);
+  }
+};
+
+// Keeps the compiler from discarding the parse results
+volatile int sink;
+
+void report(const char* name, uint32_t elapsed, uint32_t allocations) {
+  uint32_t parsed = rounds * messageCount;
+  Serial.printf("%-16s %8lu msg/s %6.2f allocations/msg\n", name,
+                (unsigned long)(parsed * 1000000ULL / (elapsed ? elapsed : 1)),
+                (float)allocations / parsed);
+}
+
+void benchmarkJsonDocument() {
+  CountingAllocator allocator;
+  uint32_t start = micros();
+  for (int r = 0; r < rounds; r++) {
+    for (int i = 0; i < messageCount; i++) {
+      JsonDocument doc(&allocator);
+      if (deserializeJson(doc, messages[i])) {
+        continue;
+      }
+      const char* type = doc["type"];
+      const char* id = doc["id"] | "";
+      sink = strcmp(type, "slider_change") == 0 ? (int)doc["value"] : id[0];
+    }
+  }
+  report("JsonDocument", micros() - start, allocator.allocations);
+}
+
+void benchmarkDashboardMessage() {
+  // The parser works in place, so each message is copied to a frame first,
+  // as if it had just arrived; the copy is part of the measurement
+  char frame[128];
+  uint32_t start = micros();
+  for (int r = 0; r < rounds; r++) {
+    for (int i = 0; i < messageCount; i++) {
+      size_t length = strlen(messages[i]);
+      memcpy(frame, messages[i], length);
+
+      DashboardMessage msg;
+      if (!msg.parse(frame, length)) {
+        continue;
+      }
+      sink = msg.type == DashboardMessageType::SLIDER_CHANGE
+                 ? msg.number
+                 : (msg.id ? msg.id[0] : 0);
+    }
+  }
+
+  // The parser has no allocator to count: it only writes into the frame
+  report("DashboardMessage", micros() - start, 0);
+}
+
+void setup() {
+  Serial.begin(115200);
+  Serial.println("ESP32 Web Dashboard Message Benchmark");
+
+  benchmarkJsonDocument();
+  benchmarkDashboardMessage();
+}
+
+void loop() { delay(1000); }
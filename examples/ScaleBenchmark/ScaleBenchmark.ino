@@ -0,0 +1,86 @@
+/**
+ * ScaleBenchmark.ino - Component scaling test for ESP32-WebCommunication
+ *
+ * This example builds dashboards of 100, 1000 and 5000 components and prints
+ * how long registration, updates by id and updates by handle take, and how
+ * much memory the components use. No WiFi connection is needed; the numbers
+ * cover the component storage and id lookup, not the network.
+ *
+ * Hardware:
+ * - ESP32 board (5000 components need PSRAM)
+ */
+
+#include <Arduino.h>
+#include <WebDashboard.h>
+
+// Dashboard sizes to measure
+const int sizes[] = {100, 1000, 5000};
+
+// Small built-in table; everything above it goes to growable segments
+typedef BasicWebDashboard<64, 1, 1, 16> ScaleDashboard;
+
+void measure(int count) {
+  size_t heapBefore = ESP.getFreeHeap() + ESP.getFreePsram();
+
+  ScaleDashboard* dashboard = new ScaleDashboard();
+  if (!dashboard || !dashboard->setMaxComponents(count)) {
+    Serial.printf("%5d: could not create dashboard\n", count);
+    delete dashboard;
+    return;
+  }
+
+  TextInputHandle* handles = new TextInputHandle[count];
+  char id[16];
+
+  uint32_t start = micros();
+  for (int i = 0; i < count; i++) {
+    snprintf(id, sizeof(id), "sensor%d", i);
+    handles[i] = dashboard->addTextInput(id, "Sensor", "0");
+  }
+  uint32_t addTime = micros() - start;
+
+  if (dashboard->getComponentCount() != count) {
+    Serial.printf("%5d: out of memory after %d components\n", count,
+                  dashboard->getComponentCount());
+  }
+
+  start = micros();
+  for (int i = 0; i < count; i++) {
+    snprintf(id, sizeof(id), "sensor%d", i);
+    dashboard->updateValue(id, i);
+  }
+  uint32_t idTime = micros() - start;
+
+  start = micros();
+  for (int i = 0; i < count; i++) {
+    dashboard->updateValue(handles[i], i + 1);
+  }
+  uint32_t handleTime = micros() - start;
+
+  size_t heapUsed = heapBefore - (ESP.getFreeHeap() + ESP.getFreePsram());
+  const DashboardStats& stats = dashboard->getStats();
+
+  Serial.printf("%5d: add=%luus byId=%luus byHandle=%luus (per component)\n",
+                count, (unsigned long)(addTime / count),
+                (unsigned long)(idTime / count),
+                (unsigned long)(handleTime / count));
+  Serial.printf(
+      "       heap=%lu table=%lu index=%lu strings=%lu fragments=%lu\n",
+      (unsigned long)heapUsed, (unsigned long)stats.componentBytes,
+      (unsigned long)stats.indexBytes, (unsigned long)stats.stringBytes,
+      (unsigned long)stats.fragmentBytes);
+
+  delete[] handles;
+  delete dashboard;
+}
+
+void setup() {
+  Serial.begin(115200);
+  Serial.println("ESP32 Web Dashboard Scale Benchmark");
+
+  for (int i = 0; i < (int)(sizeof(sizes) / sizeof(sizes[0])); i++) {
+    measure(sizes[i]);
+  }
+}
+
+void loop() { delay(1000); }
@@ -38,6 +38,12 @@ const int analogHighThreshold = 3000;
 // Dashboard instance
 WebDashboard dashboard;
 
+// Handles for the components updated on every sensor read
+TextInputHandle analogDisplay;
+TextInputHandle digitalDisplay;
+TextInputHandle temperatureDisplay;
+TextInputHandle humidityDisplay;
+
 // Uncomment to use DHT sensor
 // DHT dht(dhtPin, DHT22);  // Change to DHT11 if using that sensor
 
@@ -72,8 +78,8 @@ void updateSensors() {
   digitalValue = digitalRead(digitalSensorPin);
 
   // Update dashboard with sensor values
-  dashboard.updateValue("sensor_analog", analogValue);
-  dashboard.updateValue("sensor_digital", digitalValue ? "ON" : "OFF");
+  dashboard.updateValue(analogDisplay, analogValue);
+  dashboard.updateValue(digitalDisplay, digitalValue ? "ON" : "OFF");
 
   // Check thresholds for analog sensor
   if (analogValue < analogLowThreshold) {
@@ -112,8 +118,8 @@ void updateDhtSensor() {
   humidity = 45.0 + (random(-50, 50) / 10.0);
 
   // Update dashboard with temperature and humidity values
-  dashboard.updateValue("sensor_temp", temperature, 1);
-  dashboard.updateValue("sensor_humidity", humidity, 1);
+  dashboard.updateValue(temperatureDisplay, temperature, 1);
+  dashboard.updateValue(humidityDisplay, humidity, 1);
 }
 
 void setup() {
@@ -155,10 +161,13 @@ void setup() {
                           INPUT_PULLUP, false);
 
   // Add components for displaying sensor values
-  dashboard.addTextInput("sensor_analog", "Analog Value", "0");
-  dashboard.addTextInput("sensor_digital", "Digital State", "OFF");
-  dashboard.addTextInput("sensor_temp", "Temperature (°C)", "0.0");
-  dashboard.addTextInput("sensor_humidity", "Humidity (%)", "0.0");
+  analogDisplay = dashboard.addTextInput("sensor_analog", "Analog Value", "0");
+  digitalDisplay =
+      dashboard.addTextInput("sensor_digital", "Digital State", "OFF");
+  temperatureDisplay =
+      dashboard.addTextInput("sensor_temp", "Temperature (°C)", "0.0");
+  humidityDisplay =
+      dashboard.addTextInput("sensor_humidity", "Humidity (%)", "0.0");
 
   // Add threshold controls
   dashboard.addSlider("slider_low_threshold", "Low Threshold", 0, 4095,
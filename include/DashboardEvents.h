@@ -0,0 +1,173 @@
+/**
+ * DashboardEvents.h - Server-Sent Events stream for WebDashboard
+ *
+ * Read-only viewers such as wall displays and scrapers can follow the
+ * dashboard at /events instead of opening a WebSocket. Every frame sent to
+ * all clients is formatted as an event once, into one pool buffer, and put
+ * in a ring that all viewers read from; the frame counts the viewers that
+ * still have to send it and is released when the last one has. A viewer
+ * only costs a few bytes of state, however many there are.
+ *
+ * A viewer first gets the schema and state as pages of its own, then the
+ * frames published from then on; it holds nothing in the ring while it
+ * pages, so slow paging never costs it its place. One that falls a whole
+ * ring behind is disconnected, and the browser reconnects and starts over.
+ */
+
+#ifndef DashboardEvents_h
+#define DashboardEvents_h
+
+#include <Arduino.h>
+
+#include "DashboardPool.h"
+
+// Viewers that can follow /events at the same time
+#ifndef DASHBOARD_EVENT_VIEWERS
+#define DASHBOARD_EVENT_VIEWERS 8
+#endif
+// Published frames kept for viewers that haven't sent them yet
+#ifndef DASHBOARD_EVENT_RING
+#define DASHBOARD_EVENT_RING 16
+#endif
+// A viewer with nothing to send gets a comment this often, so a dead
+// connection is noticed
+#ifndef DASHBOARD_EVENT_KEEPALIVE
+#define DASHBOARD_EVENT_KEEPALIVE 10000
+#endif
+
+// Viewer ids have this bit set, so they never clash with WebSocket clients
+#define DASHBOARD_EVENT_CLIENT 0x80000000u
+
+// Event stream counters
+struct DashboardEventStats {
+  uint16_t viewers;         // Viewers connected now
+  uint16_t highWater;       // Most frames in the ring at once
+  uint32_t published;       // Frames put in the ring
+  uint32_t delivered;       // Frames fully handed to a viewer's connection
+  uint32_t copiesSaved;     // Deliveries that shared a frame with another
+  uint32_t viewersDropped;  // Viewers disconnected for falling behind
+};
+
+class DashboardEvents {
+ public:
+  explicit DashboardEvents(DashboardPool& pool);
+  ~DashboardEvents();
+
+  /**
+   * Add a viewer. It receives nothing from the ring until stream() is
+   * called.
+   *
+   * @return Viewer id, or 0 if all DASHBOARD_EVENT_VIEWERS are taken
+   */
+  uint32_t open();
+
+  /**
+   * Take a viewer opened since the last call, so the task that pages the
+   * schema and state to viewers learns of it from its own side
+   *
+   * @return Viewer id, or 0 if there is none
+   */
+  uint32_t accept();
+
+  /**
+   * Remove a viewer, e.g. after its connection closed; unknown ids are
+   * ignored
+   */
+  void close(uint32_t id);
+
+  /**
+   * Whether a viewer is still connected and keeping up
+   */
+  bool connected(uint32_t id);
+
+  /**
+   * Whether a viewer can take a page from send()
+   */
+  bool ready(uint32_t id);
+
+  /**
+   * Copy a page for one viewer, sent before anything from the ring
+   *
+   * @return false if the viewer is gone or still has a page to send
+   */
+  bool send(uint32_t id, const char* data, size_t length);
+
+  /**
+   * Let a viewer go on with the frames published from now on
+   */
+  void stream(uint32_t id);
+
+  /**
+   * Copy a frame into the ring for every viewer
+   */
+  void publish(const char* data, size_t length);
+
+  /**
+   * Get the number of viewers
+   */
+  int count();
+
+  /**
+   * Write the next bytes of a viewer's stream; called from the response's
+   * filler on the web server's task
+   *
+   * @param id Viewer id
+   * @param buffer Where to write
+   * @param maxLength Room in buffer
+   * @return Bytes written, RESPONSE_TRY_AGAIN if there is nothing to send
+   *         yet, or 0 to end the response of a viewer that is gone
+   */
+  size_t fill(uint32_t id, uint8_t* buffer, size_t maxLength);
+
+  /**
+   * Get the counters
+   */
+  void getStats(DashboardEventStats* stats);
+
+  /**
+   * Reset the counters; the viewer count and high water are kept
+   */
+  void resetStats();
+
+ private:
+  DashboardEvents(const DashboardEvents&);
+  DashboardEvents& operator=(const DashboardEvents&);
+
+  struct Frame {
+    char* data;  // "data: <frame>\n\n"
+    uint16_t length;
+    uint8_t refs;  // Viewers yet to send it
+  };
+
+  struct Viewer {
+    uint32_t id;      // 0 when the slot is free
+    uint32_t next;    // Number of the next ring frame to send
+    uint16_t offset;  // Bytes of the current page or frame already sent
+    char* page;       // Page of its own, sent before the ring
+    uint16_t pageLength;
+    uint32_t lastSent;
+    bool greeted;  // Reconnect delay sent
+    bool accepted;
+    bool streaming;  // Reading the ring; holds references from next on
+    bool lost;  // Closed or fell behind; holds no references
+  };
+
+  Frame& at(uint32_t number) {
+    return _frames[number % DASHBOARD_EVENT_RING];
+  }
+  Viewer* find(uint32_t id);
+  char* format(const char* data, size_t length);
+  bool release(Viewer* viewer);
+  int trim(char** freed);
+
+  DashboardPool& _pool;
+  Frame _frames[DASHBOARD_EVENT_RING];
+  uint32_t _first;  // Number of the oldest frame kept
+  uint32_t _next;   // Number the next frame gets
+  Viewer _viewers[DASHBOARD_EVENT_VIEWERS];
+  uint8_t _generation;
+  DashboardEventStats _stats;
+  portMUX_TYPE _lock;
+};
+
+#endif  // DashboardEvents_h
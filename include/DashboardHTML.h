@@ -160,13 +160,37 @@ static const char DASHBOARD_HTML[] PROGMEM = R"rawliteral(
             overflow-y: auto;
             font-family: monospace;
             font-size: 12px;
-            padding: 8px;
+            padding: 0 8px;
+        }
+
+        /* As tall as all the lines; the rows in sight are moved over it */
+        .log-spacer {
+            position: relative;
+        }
+
+        .log-rows {
+            position: absolute;
+            top: 0;
+            left: 0;
+            right: 0;
         }
 
+        /* Rows have a fixed height, so a line's position is its index */
         .log-entry {
-            margin-bottom: 4px;
+            height: 20px;
+            line-height: 16px;
             padding: 2px 4px;
             border-radius: 2px;
+            white-space: nowrap;
+            overflow: hidden;
+            text-overflow: ellipsis;
+        }
+
+        .log-filters {
+            display: flex;
+            gap: 12px;
+            margin-bottom: 4px;
+            font-size: 12px;
         }
 
         .log-info {
@@ -418,6 +442,25 @@ static const char DASHBOARD_HTML[] PROGMEM = R"rawliteral(
                 grid-template-columns: repeat(auto-fill, minmax(120px, 1fr));
             }
         }
+
+        /* Cards outside the viewport skip layout and paint */
+        .pin-monitor,
+        .setting-item {
+            content-visibility: auto;
+            contain-intrinsic-size: auto 64px;
+        }
+
+        .render-sentinel {
+            grid-column: 1 / -1;
+            height: 1px;
+        }
+
+        /* Devices built without inbound controls */
+        .read-only .controls-grid,
+        .read-only .settings-grid {
+            pointer-events: none;
+            opacity: 0.6;
+        }
     </style>
 </head>
 <body>
@@ -444,7 +487,17 @@ static const char DASHBOARD_HTML[] PROGMEM = R"rawliteral(
             <div class="monitoring-grid">
                 <div>
                     <h3 class="section-title">Logs</h3>
-                    <div class="log-container" id="log-container"></div>
+                    <div class="log-filters" id="log-filters">
+                        <label><input type="checkbox" data-level="0" checked> Info</label>
+                        <label><input type="checkbox" data-level="1" checked> Warning</label>
+                        <label><input type="checkbox" data-level="2" checked> Error</label>
+                        <label><input type="checkbox" data-level="3" checked> Debug</label>
+                    </div>
+                    <div class="log-container" id="log-container">
+                        <div class="log-spacer" id="log-spacer">
+                            <div class="log-rows" id="log-rows"></div>
+                        </div>
+                    </div>
                 </div>
                 <div>
                     <h3 class="section-title">Pin Monitoring</h3>
@@ -465,20 +518,49 @@ static const char DASHBOARD_HTML[] PROGMEM = R"rawliteral(
     </div>
 
     <script>
+        // Opened with ?display, the page is a read-only display that follows
+        // the device over Server-Sent Events instead of a WebSocket
+        const display = new URLSearchParams(window.location.search).has('display');
+
         // WebSocket connection
-        const webSocket = new WebSocket('ws://' + window.location.hostname + '/ws');
+        const webSocket = display ? null : new WebSocket('ws://' + window.location.hostname + '/ws');
         const statusDot = document.getElementById('status-dot');
         const connectionStatus = document.getElementById('connection-status');
         const machineState = document.getElementById('machine-state');
         
         // Section containers
         const logContainer = document.getElementById('log-container');
+        const logSpacer = document.getElementById('log-spacer');
+        const logRows = document.getElementById('log-rows');
         const pinGrid = document.getElementById('pin-grid');
         const controlsGrid = document.getElementById('controls-grid');
         const settingsGrid = document.getElementById('settings-grid');
         
-        // Track components
+        // Track components, and the card elements of the rendered ones
         let components = {};
+        let views = new Map();
+
+        // Component schema (ids, types, labels, config) cached across page
+        // loads, keyed by the hash the device computes over it
+        let schema = loadCachedSchema();
+
+        // Large dashboards send the schema and state in several pages,
+        // collected here until the last one arrives
+        let schemaPages = null;
+        let statePages = null;
+
+        // Cards are created a block at a time as the end of their grid
+        // scrolls into view, so thousands of components don't all turn into
+        // DOM nodes up front
+        const RENDER_BLOCK = 100;
+        const renderQueues = new Map();
+        const renderObserver = new IntersectionObserver(entries => {
+            entries.forEach(entry => {
+                if (entry.isIntersecting) {
+                    renderNextBlock(entry.target.parentNode);
+                }
+            });
+        });
 
         // Navigation
         document.querySelectorAll('.nav-tab').forEach(tab => {
@@ -491,141 +573,491 @@ static const char DASHBOARD_HTML[] PROGMEM = R"rawliteral(
                 const sectionId = this.dataset.section;
                 document.querySelectorAll('.section').forEach(s => s.classList.remove('active'));
                 document.getElementById(sectionId).classList.add('active');
+                subscribe();
+
+                // The log view can only size its rows while it is shown
+                logsChanged = true;
+                scheduleRender();
             });
         });
 
-        // WebSocket event handlers
-        webSocket.onopen = function() {
-            statusDot.classList.remove('disconnected');
-            statusDot.classList.add('connected');
-            connectionStatus.textContent = 'Connected';
-            
-            // Request full dashboard data
-            webSocket.send(JSON.stringify({ type: 'request_full_update' }));
-        };
+        // Component groups shown on each tab (GROUP_* on the device)
+        const sectionGroups = { monitoring: 1, controls: 2, settings: 4 };
 
-        webSocket.onclose = function() {
-            statusDot.classList.remove('connected');
-            statusDot.classList.add('disconnected');
-            connectionStatus.textContent = 'Disconnected';
-            
-            // Try to reconnect after 2 seconds
-            setTimeout(function() {
-                window.location.reload();
-            }, 2000);
-        };
+        // Ask for value updates of the visible tab only; the device sends
+        // the current values when we switch
+        function subscribe() {
+            if (!webSocket || webSocket.readyState !== WebSocket.OPEN) {
+                return;
+            }
+            const section = document.querySelector('.section.active');
+            webSocket.send(JSON.stringify({
+                type: 'subscribe',
+                groups: sectionGroups[section.id] || 0
+            }));
+        }
+
+        function setConnected(connected) {
+            statusDot.classList.toggle('connected', connected);
+            statusDot.classList.toggle('disconnected', !connected);
+            connectionStatus.textContent = connected ? 'Connected' : 'Disconnected';
+        }
+
+        if (display) {
+            // The device sends the schema and state on every connect, and
+            // the browser reconnects by itself
+            document.body.classList.add('read-only');
+            const events = new EventSource('/events');
+            events.onopen = function() {
+                setConnected(true);
+            };
+            events.onerror = function() {
+                setConnected(false);
+            };
+            events.onmessage = handleMessage;
+        } else {
+            // WebSocket event handlers
+            webSocket.onopen = function() {
+                setConnected(true);
+                
+                // Request full dashboard data, presenting the cached schema hash
+                // so the device can skip resending an unchanged schema
+                webSocket.send(JSON.stringify({
+                    type: 'request_full_update',
+                    schemaHash: schema ? schema.hash : ''
+                }));
+                subscribe();
+            };
+
+            webSocket.onclose = function() {
+                setConnected(false);
+                
+                // Try to reconnect after 2 seconds
+                setTimeout(function() {
+                    window.location.reload();
+                }, 2000);
+            };
+
+            webSocket.onerror = function(error) {
+                console.error('WebSocket error:', error);
+            };
 
-        webSocket.onerror = function(error) {
-            console.error('WebSocket error:', error);
-        };
+            webSocket.onmessage = handleMessage;
+        }
 
-        webSocket.onmessage = function(event) {
+        function handleMessage(event) {
             const data = JSON.parse(event.data);
             
-            if (data.type === 'full_update') {
-                handleFullUpdate(data);
+            if (data.type === 'schema') {
+                handleSchema(data);
+            } else if (data.type === 'state') {
+                handleState(data);
             } else if (data.type === 'component_update') {
                 handleComponentUpdate(data.component);
+            } else if (data.type === 'component_removed') {
+                handleComponentRemoved(data.id);
+            } else if (data.type === 'batch_update') {
+                handleBatchUpdate(data);
             } else if (data.type === 'log') {
                 addLogEntry(data.entry);
             } else if (data.type === 'machine_state') {
                 updateMachineState(data.state);
             }
-        };
+        }
+
+        function loadCachedSchema() {
+            try {
+                return JSON.parse(localStorage.getItem('dashboardSchema'));
+            } catch (e) {
+                return null;
+            }
+        }
+
+        function storeCachedSchema(value) {
+            try {
+                if (value) {
+                    localStorage.setItem('dashboardSchema', JSON.stringify(value));
+                } else {
+                    localStorage.removeItem('dashboardSchema');
+                }
+            } catch (e) {
+                // Storage unavailable; the schema is simply resent next time
+            }
+        }
+
+        // Handle the component schema sent when our cached copy is stale
+        function handleSchema(data) {
+            if (!data.offset) {
+                schemaPages = [];
+            } else if (!schemaPages) {
+                return; // We missed the first page
+            }
+            Array.prototype.push.apply(schemaPages, data.components);
+            if (data.more) {
+                return;
+            }
+
+            schema = { hash: data.hash, readOnly: !!data.readOnly, components: schemaPages };
+            schemaPages = null;
+            storeCachedSchema(schema);
+        }
+
+        // Handle the full dashboard state: values for every component in
+        // the schema, plus machine state and recent logs
+        function handleState(data) {
+            if (!data.offset) {
+                statePages = { machineState: data.machineState, values: {} };
+            } else if (!statePages) {
+                return; // We missed the first page
+            }
+
+            if (!schema || schema.hash !== data.hash) {
+                // The schema changed since we cached it; ask for it again. A
+                // display gets the new schema without asking.
+                statePages = null;
+                schema = null;
+                storeCachedSchema(null);
+                sendMessage({ type: 'request_full_update', schemaHash: '' });
+                return;
+            }
+
+            (data.values || []).forEach(value => {
+                statePages.values[value.id] = value;
+            });
+            if (data.more) {
+                return;
+            }
+            const state = statePages;
+            statePages = null;
 
-        // Handle full dashboard update
-        function handleFullUpdate(data) {
-            // Clear all containers
-            pinGrid.innerHTML = '';
-            controlsGrid.innerHTML = '';
-            settingsGrid.innerHTML = '';
-            logContainer.innerHTML = '';
+            // Devices built without inbound controls get a read-only view
+            document.body.classList.toggle('read-only', display || !!schema.readOnly);
             
             // Update machine state
-            if (data.machineState) {
-                updateMachineState(data.machineState);
+            if (state.machineState) {
+                updateMachineState(state.machineState);
             }
             
-            // Process components
+            // Merge values into the schema and sort the components by grid
             components = {};
-            if (data.components) {
-                data.components.forEach(component => {
-                    components[component.id] = component;
+            const lists = new Map([[pinGrid, []], [controlsGrid, []], [settingsGrid, []]]);
+            schema.components.forEach(definition => {
+                const component = Object.assign({}, definition, state.values[definition.id]);
+                components[component.id] = component;
+                const grid = gridFor(component);
+                if (grid) {
+                    lists.get(grid).push(component);
+                } else {
                     createComponent(component);
-                });
-            }
+                }
+            });
+
+            // The state carries every value, so nothing drawn is pending
+            dirtyComponents.clear();
+
+            // Match the grids to the new lists, keeping the cards that are
+            // still there, and drop the cards of components that are gone
+            const stale = views;
+            views = new Map();
+            lists.forEach((list, grid) => reconcileGrid(grid, list, stale));
+            stale.forEach(view => view.root.remove());
             
-            // Process logs
-            if (data.logs) {
-                data.logs.forEach(entry => {
-                    addLogEntry(entry);
-                });
+            // The device's recent logs replace ours
+            logFirst = logNext = 0;
+            logShown = [];
+            logShownStart = 0;
+            logFollow = true;
+            (data.logs || []).forEach(addLogEntry);
+        }
+
+        // Bring a grid's cards in line with a list of components. As many
+        // cards as were rendered before are rendered again, in list order;
+        // a card is reused when its component's definition is unchanged and
+        // only moved if it is out of place. The rest are queued.
+        function reconcileGrid(grid, list, stale) {
+            const old = renderQueues.get(grid);
+            const rendered = Math.min(list.length, old ? old.next : 0);
+
+            let cursor = grid.firstChild;
+            for (let i = 0; i < rendered; i++) {
+                const component = list[i];
+                let view = stale.get(component.id);
+                if (view && view.key === definitionKey(component)) {
+                    stale.delete(component.id);
+                    views.set(component.id, view);
+                    updateComponentValue(component, view);
+                } else {
+                    view = createComponent(component);
+                }
+
+                if (view.root === cursor) {
+                    cursor = cursor.nextSibling;
+                } else {
+                    grid.insertBefore(view.root, cursor);
+                }
             }
-        }
 
-        // Handle component update
-        function handleComponentUpdate(component) {
-            components[component.id] = component;
-            
-            const existingElement = document.getElementById(`component-${component.id}`);
-            if (existingElement) {
-                updateComponentValue(component);
+            const queue = {
+                components: list,
+                next: rendered,
+                sentinel: old ? old.sentinel : document.createElement('div')
+            };
+            queue.sentinel.className = 'render-sentinel';
+            renderQueues.set(grid, queue);
+
+            renderObserver.unobserve(queue.sentinel);
+            if (queue.next < list.length) {
+                grid.appendChild(queue.sentinel);
+                renderObserver.observe(queue.sentinel);
             } else {
+                queue.sentinel.remove();
+            }
+        }
+
+        // What a card is built from: everything but the value
+        function definitionKey(component) {
+            return JSON.stringify(component, (key, value) =>
+                key === 'value' || key === 'precision' ? undefined : value);
+        }
+
+        // Handle a batch of changes committed together on the device
+        function handleBatchUpdate(data) {
+            if (data.machineState) {
+                updateMachineState(data.machineState);
+            }
+            if (data.components) {
+                data.components.forEach(handleComponentUpdate);
+            }
+        }
+
+        // Handle component update. Updates normally carry only the id and
+        // value; a component added after connecting also carries its schema.
+        function handleComponentUpdate(update) {
+            if (statePages) {
+                // A state is being collected; the update may be newer than
+                // the page that carried this component
+                statePages.values[update.id] = update;
+            }
+
+            // The device's value replaces whatever this page sent last
+            delete sentInputs[update.id];
+
+            const existing = components[update.id];
+            if (existing) {
+                delete existing.precision;
+                const component = Object.assign(existing, update);
+                if (component.type === 7) {
+                    updateMachineState(component.value);
+                } else {
+                    dirtyComponents.add(component.id);
+                    scheduleRender();
+                }
+            } else if (update.type !== undefined) {
+                components[update.id] = update;
+                queueComponent(update);
+
+                // Our cached schema no longer matches the device
+                schema = null;
+                storeCachedSchema(null);
+            }
+        }
+
+        // Handle a component removed on the device: drop its card in place
+        function handleComponentRemoved(id) {
+            if (statePages) {
+                delete statePages.values[id];
+            }
+
+            const component = components[id];
+            if (component) {
+                delete components[id];
+                dirtyComponents.delete(id);
+
+                // A card that hasn't been rendered yet leaves its queue
+                const queue = renderQueues.get(gridFor(component));
+                const index = queue ? queue.components.indexOf(component) : -1;
+                if (index >= 0) {
+                    queue.components.splice(index, 1);
+                    if (index < queue.next) {
+                        queue.next--;
+                    }
+                }
+
+                const view = views.get(id);
+                if (view) {
+                    views.delete(id);
+                    view.root.remove();
+                }
+            }
+
+            // Our cached schema no longer matches the device
+            schema = null;
+            storeCachedSchema(null);
+        }
+
+        // Grid a component's card goes into, if it has one
+        function gridFor(component) {
+            switch (component.type) {
+                case 1:
+                    return controlsGrid;
+                case 2:
+                case 3:
+                case 4:
+                case 5:
+                    return settingsGrid;
+                case 6:
+                    return pinGrid;
+                default:
+                    return null;
+            }
+        }
+
+        // Queue a card for its grid; the grid renders it once the end of the
+        // grid comes into view. Updates before then only touch the model.
+        function queueComponent(component) {
+            const grid = gridFor(component);
+            if (!grid) {
                 createComponent(component);
+                return;
+            }
+
+            let queue = renderQueues.get(grid);
+            if (!queue) {
+                queue = { components: [], next: 0, sentinel: document.createElement('div') };
+                queue.sentinel.className = 'render-sentinel';
+                renderQueues.set(grid, queue);
+            }
+            queue.components.push(component);
+            if (!queue.sentinel.parentNode) {
+                grid.appendChild(queue.sentinel);
+                renderObserver.observe(queue.sentinel);
+            }
+        }
+
+        // Create the next block of queued cards for a grid, inserting them
+        // into the page in one go
+        function renderNextBlock(grid) {
+            const queue = renderQueues.get(grid);
+            if (!queue) {
+                return;
+            }
+
+            const block = document.createDocumentFragment();
+            const end = Math.min(queue.next + RENDER_BLOCK, queue.components.length);
+            for (; queue.next < end; queue.next++) {
+                block.appendChild(createComponent(queue.components[queue.next]).root);
+            }
+            grid.insertBefore(block, queue.sentinel.parentNode === grid ? queue.sentinel : null);
+
+            // Keep the sentinel last. Observing it again reports whether it
+            // is still in view, which renders the next block if so.
+            renderObserver.unobserve(queue.sentinel);
+            if (queue.next < queue.components.length) {
+                grid.appendChild(queue.sentinel);
+                renderObserver.observe(queue.sentinel);
+            } else {
+                queue.sentinel.remove();
             }
         }
 
-        // Create a component based on its type
+        // Create a component's card based on its type and remember the
+        // elements its updates touch. The caller puts the card in place.
         function createComponent(component) {
+            let view = null;
             switch (component.type) {
                 case 1: // Button
-                    createButton(component);
+                    view = createButton(component);
                     break;
                 case 2: // Toggle
-                    createToggle(component);
+                    view = createToggle(component);
                     break;
                 case 3: // Slider
-                    createSlider(component);
+                    view = createSlider(component);
                     break;
                 case 4: // Text Input
-                    createTextInput(component);
+                    view = createTextInput(component);
                     break;
                 case 5: // Select
-                    createSelect(component);
+                    view = createSelect(component);
                     break;
                 case 6: // Pin Monitor
-                    createPinMonitor(component);
+                    view = createPinMonitor(component);
                     break;
                 case 7: // Machine State
                     updateMachineState(component.value);
                     break;
             }
+            if (view) {
+                view.key = definitionKey(component);
+                views.set(component.id, view);
+            }
+            return view;
         }
 
-        // Update a component's value
-        function updateComponentValue(component) {
+        // Update a card to a component's value
+        function updateComponentValue(component, view) {
             switch (component.type) {
                 case 2: // Toggle
-                    updateToggle(component);
+                    updateToggle(component, view);
                     break;
                 case 3: // Slider
-                    updateSlider(component);
+                    updateSlider(component, view);
                     break;
                 case 4: // Text Input
-                    updateTextInput(component);
+                    updateTextInput(component, view);
                     break;
                 case 5: // Select
-                    updateSelect(component);
+                    updateSelect(component, view);
                     break;
                 case 6: // Pin Monitor
-                    updatePinMonitor(component);
-                    break;
-                case 7: // Machine State
-                    updateMachineState(component.value);
+                    updatePinMonitor(component, view);
                     break;
             }
         }
 
+        // Value changes are applied to the model as they arrive and drawn
+        // once per animation frame, however many arrived in between
+        const dirtyComponents = new Set();
+        let pendingMachineState = null;
+        let renderFrame = 0;
+
+        function scheduleRender() {
+            if (!renderFrame) {
+                renderFrame = requestAnimationFrame(flushRender);
+            }
+        }
+
+        function flushRender() {
+            renderFrame = 0;
+            if (logsChanged) {
+                // First, while nothing has invalidated the layout it reads
+                logsChanged = false;
+                renderLogs();
+            }
+
+            dirtyComponents.forEach(id => {
+                const view = views.get(id);
+                if (view) {
+                    updateComponentValue(components[id], view);
+                }
+            });
+            dirtyComponents.clear();
+
+            if (pendingMachineState !== null) {
+                machineState.textContent = pendingMachineState;
+                pendingMachineState = null;
+            }
+        }
+
+        // Format a component value for display. Floats arrive as numbers
+        // together with the number of decimals to show.
+        function formatValue(component) {
+            if (typeof component.value === 'number' && component.precision !== undefined) {
+                return component.value.toFixed(component.precision);
+            }
+            return component.value;
+        }
+
         // Component creation functions
         function createButton(component) {
             const button = document.createElement('button');
@@ -636,7 +1068,7 @@ static const char DASHBOARD_HTML[] PROGMEM = R"rawliteral(
                 sendButtonPress(component.id);
             };
             
-            controlsGrid.appendChild(button);
+            return { root: button };
         }
 
         function createToggle(component) {
@@ -667,7 +1099,7 @@ static const char DASHBOARD_HTML[] PROGMEM = R"rawliteral(
             settingItem.appendChild(label);
             settingItem.appendChild(toggleContainer);
             
-            settingsGrid.appendChild(settingItem);
+            return { root: settingItem, input: input };
         }
 
         function createSlider(component) {
@@ -694,11 +1126,9 @@ static const char DASHBOARD_HTML[] PROGMEM = R"rawliteral(
             valueDisplay.className = 'slider-value';
             valueDisplay.textContent = component.value;
             
+            // The device follows the slider while it is dragged
             input.oninput = function() {
                 valueDisplay.textContent = this.value;
-            };
-            
-            input.onchange = function() {
                 sendSliderChange(component.id, parseInt(this.value));
             };
             
@@ -708,7 +1138,7 @@ static const char DASHBOARD_HTML[] PROGMEM = R"rawliteral(
             settingItem.appendChild(label);
             settingItem.appendChild(sliderContainer);
             
-            settingsGrid.appendChild(settingItem);
+            return { root: settingItem, input: input, value: valueDisplay };
         }
 
         function createTextInput(component) {
@@ -723,7 +1153,7 @@ static const char DASHBOARD_HTML[] PROGMEM = R"rawliteral(
             const input = document.createElement('input');
             input.type = 'text';
             input.className = 'text-input';
-            input.value = component.value;
+            input.value = formatValue(component);
             
             input.onchange = function() {
                 sendTextInputChange(component.id, this.value);
@@ -732,7 +1162,7 @@ static const char DASHBOARD_HTML[] PROGMEM = R"rawliteral(
             settingItem.appendChild(label);
             settingItem.appendChild(input);
             
-            settingsGrid.appendChild(settingItem);
+            return { root: settingItem, input: input };
         }
 
         function createSelect(component) {
@@ -764,13 +1194,14 @@ static const char DASHBOARD_HTML[] PROGMEM = R"rawliteral(
             settingItem.appendChild(label);
             settingItem.appendChild(select);
             
-            settingsGrid.appendChild(settingItem);
+            return { root: settingItem, input: select };
         }
 
         function createPinMonitor(component) {
             const pinMonitor = document.createElement('div');
             pinMonitor.className = 'pin-monitor';
             pinMonitor.id = `component-${component.id}`;
+            const view = { root: pinMonitor };
             
             const label = document.createElement('div');
             label.className = 'pin-label';
@@ -783,11 +1214,13 @@ static const char DASHBOARD_HTML[] PROGMEM = R"rawliteral(
                 const indicator = document.createElement('div');
                 indicator.className = `pin-digital ${component.value ? 'pin-on' : 'pin-off'}`;
                 pinMonitor.appendChild(indicator);
+                view.indicator = indicator;
             }
             
             const value = document.createElement('div');
             value.className = 'pin-value';
-            value.textContent = component.value;
+            value.textContent = formatValue(component);
+            view.value = value;
             
             if (isAnalog) {
                 // Analog pin with progress bar
@@ -801,148 +1234,248 @@ static const char DASHBOARD_HTML[] PROGMEM = R"rawliteral(
                 
                 bar.appendChild(progress);
                 pinMonitor.appendChild(bar);
+                view.progress = progress;
             }
             
             pinMonitor.appendChild(label);
             pinMonitor.appendChild(value);
             
-            pinGrid.appendChild(pinMonitor);
+            return view;
         }
 
-        // Component update functions
-        function updateToggle(component) {
-            const settingItem = document.getElementById(`component-${component.id}`);
-            if (settingItem) {
-                const input = settingItem.querySelector('input[type="checkbox"]');
-                if (input) {
-                    input.checked = component.value;
-                }
+        // Component update functions. They write through the elements
+        // remembered when the card was created, and only what changed.
+        function updateToggle(component, view) {
+            const checked = !!component.value;
+            if (view.input.checked !== checked) {
+                view.input.checked = checked;
             }
         }
 
-        function updateSlider(component) {
-            const settingItem = document.getElementById(`component-${component.id}`);
-            if (settingItem) {
-                const input = settingItem.querySelector('input[type="range"]');
-                const valueDisplay = settingItem.querySelector('.slider-value');
-                
-                if (input && valueDisplay) {
-                    input.value = component.value;
-                    valueDisplay.textContent = component.value;
-                }
+        function updateSlider(component, view) {
+            const text = String(component.value);
+            if (view.input.value !== text) {
+                view.input.value = component.value;
+            }
+            if (view.value.textContent !== text) {
+                view.value.textContent = text;
             }
         }
 
-        function updateTextInput(component) {
-            const settingItem = document.getElementById(`component-${component.id}`);
-            if (settingItem) {
-                const input = settingItem.querySelector('input[type="text"]');
-                if (input) {
-                    input.value = component.value;
-                }
+        function updateTextInput(component, view) {
+            const text = String(formatValue(component));
+            if (view.input.value !== text) {
+                view.input.value = text;
+            }
+        }
+
+        function updateSelect(component, view) {
+            if (view.input.value !== component.value) {
+                view.input.value = component.value;
+            }
+        }
+
+        function updatePinMonitor(component, view) {
+            const text = String(formatValue(component));
+            if (view.value.textContent !== text) {
+                view.value.textContent = text;
+            }
+
+            if (view.progress) {
+                const percentage = ((component.value - component.min) / (component.max - component.min)) * 100;
+                view.progress.style.width = `${percentage}%`;
+            } else if (view.indicator) {
+                view.indicator.classList.toggle('pin-on', !!component.value);
+                view.indicator.classList.toggle('pin-off', !component.value);
             }
         }
 
-        function updateSelect(component) {
-            const settingItem = document.getElementById(`component-${component.id}`);
-            if (settingItem) {
-                const select = settingItem.querySelector('select');
-                if (select) {
-                    select.value = component.value;
+        function updateMachineState(state) {
+            pendingMachineState = state;
+            scheduleRender();
+        }
+
+        // Log entries are kept in a ring buffer of LOG_CAPACITY entries,
+        // numbered in arrival order. The log view only has DOM rows for the
+        // lines in sight, moved over a spacer as tall as all the lines that
+        // pass the level filter.
+        const LOG_CAPACITY = 5000;
+        const LOG_ROW_HEIGHT = 20;
+        const LOG_LEVEL_NAMES = ['info', 'warning', 'error', 'debug'];
+        const logEntries = new Array(LOG_CAPACITY);
+        let logFirst = 0;        // Number of the oldest entry kept
+        let logNext = 0;         // Number the next entry gets
+        let logShown = [];       // Numbers of entries passing the filter
+        let logShownStart = 0;   // logShown entries before this were evicted
+        let logFollow = true;    // Keep the newest line in view
+        let logsChanged = false;
+        const logLevels = new Set([0, 1, 2, 3]);
+
+        function logLevel(entry) {
+            return entry.level >= 0 && entry.level <= 2 ? entry.level : 3;
+        }
+
+        // Add a log entry; the view catches up with the next frame
+        function addLogEntry(entry) {
+            if (logNext - logFirst === LOG_CAPACITY) {
+                logFirst++;
+                if (logShown[logShownStart] < logFirst) {
+                    logShownStart++;
                 }
             }
+            logEntries[logNext % LOG_CAPACITY] = entry;
+            if (logLevels.has(logLevel(entry))) {
+                logShown.push(logNext);
+            }
+            logNext++;
+
+            // Drop evicted numbers now and then rather than on every entry
+            if (logShownStart >= LOG_CAPACITY) {
+                logShown = logShown.slice(logShownStart);
+                logShownStart = 0;
+            }
+
+            logsChanged = true;
+            scheduleRender();
         }
 
-        function updatePinMonitor(component) {
-            const pinMonitor = document.getElementById(`component-${component.id}`);
-            if (pinMonitor) {
-                const valueElement = pinMonitor.querySelector('.pin-value');
-                if (valueElement) {
-                    valueElement.textContent = component.value;
+        // Rebuild the list of shown entries after the filter changed; the
+        // hidden entries never had rows to remove
+        function filterLogs() {
+            logShown = [];
+            logShownStart = 0;
+            for (let n = logFirst; n < logNext; n++) {
+                if (logLevels.has(logLevel(logEntries[n % LOG_CAPACITY]))) {
+                    logShown.push(n);
                 }
-                
-                const isAnalog = component.max > 1;
-                
-                if (isAnalog) {
-                    const progressElement = pinMonitor.querySelector('.pin-progress');
-                    if (progressElement) {
-                        const percentage = ((component.value - component.min) / (component.max - component.min)) * 100;
-                        progressElement.style.width = `${percentage}%`;
-                    }
-                } else {
-                    const indicator = pinMonitor.querySelector('.pin-digital');
-                    if (indicator) {
-                        if (component.value) {
-                            indicator.classList.add('pin-on');
-                            indicator.classList.remove('pin-off');
-                        } else {
-                            indicator.classList.add('pin-off');
-                            indicator.classList.remove('pin-on');
-                        }
-                    }
+            }
+            logsChanged = true;
+            scheduleRender();
+        }
+
+        // Fill the rows in sight. Layout is read before anything is written.
+        function renderLogs() {
+            const count = logShown.length - logShownStart;
+            const height = logContainer.clientHeight;
+            const top = logFollow
+                ? Math.max(0, count * LOG_ROW_HEIGHT - height)
+                : logContainer.scrollTop;
+
+            const first = Math.min(Math.floor(top / LOG_ROW_HEIGHT), count);
+            const end = Math.min(count, first + Math.ceil(height / LOG_ROW_HEIGHT) + 1);
+            while (logRows.children.length < end - first) {
+                const row = document.createElement('div');
+                row.number = -1;
+                logRows.appendChild(row);
+            }
+
+            for (let i = 0; i < logRows.children.length; i++) {
+                const row = logRows.children[i];
+                if (first + i >= end) {
+                    row.hidden = true;
+                    continue;
                 }
+                const number = logShown[logShownStart + first + i];
+                if (row.number !== number) {
+                    const entry = logEntries[number % LOG_CAPACITY];
+                    const time = new Date(entry.timestamp).toLocaleTimeString();
+                    row.number = number;
+                    row.className = `log-entry log-${LOG_LEVEL_NAMES[logLevel(entry)]}`;
+                    row.textContent = `[${time}] ${entry.message}`;
+                }
+                row.hidden = false;
             }
-        }
 
-        function updateMachineState(state) {
-            machineState.textContent = state;
+            logRows.style.transform = `translateY(${first * LOG_ROW_HEIGHT}px)`;
+            logSpacer.style.height = `${count * LOG_ROW_HEIGHT}px`;
+            if (logFollow) {
+                logContainer.scrollTop = top;
+            }
         }
 
-        // Add a log entry to the log container
-        function addLogEntry(entry) {
-            const logEntry = document.createElement('div');
-            logEntry.className = `log-entry log-${entry.level === 0 ? 'info' : entry.level === 1 ? 'warning' : entry.level === 2 ? 'error' : 'debug'}`;
-            
-            const time = new Date(entry.timestamp).toLocaleTimeString();
-            logEntry.textContent = `[${time}] ${entry.message}`;
-            
-            logContainer.appendChild(logEntry);
-            logContainer.scrollTop = logContainer.scrollHeight;
-            
-            // Limit the number of log entries to prevent memory issues
-            while (logContainer.children.length > 100) {
-                logContainer.removeChild(logContainer.firstChild);
+        logContainer.addEventListener('scroll', () => {
+            // Scrolling to the bottom follows new lines again
+            const count = logShown.length - logShownStart;
+            logFollow = logContainer.scrollTop + logContainer.clientHeight >=
+                count * LOG_ROW_HEIGHT - LOG_ROW_HEIGHT / 2;
+            logsChanged = true;
+            scheduleRender();
+        }, { passive: true });
+
+        document.querySelectorAll('#log-filters input').forEach(input => {
+            input.addEventListener('change', function() {
+                const level = parseInt(this.dataset.level);
+                if (this.checked) {
+                    logLevels.add(level);
+                } else {
+                    logLevels.delete(level);
+                }
+                filterLogs();
+            });
+        });
+
+        // Send messages to the server; a display has nowhere to send them
+        function sendMessage(message) {
+            if (webSocket) {
+                webSocket.send(JSON.stringify(message));
             }
         }
 
-        // Send messages to the server
         function sendButtonPress(id) {
-            webSocket.send(JSON.stringify({
+            sendMessage({
                 type: 'button_press',
                 id: id
-            }));
+            });
         }
 
         function sendToggleChange(id, state) {
-            webSocket.send(JSON.stringify({
+            sendMessage({
                 type: 'toggle_change',
                 id: id,
                 value: state
-            }));
+            });
+        }
+
+        // Slider and text input values go out at most once per animation
+        // frame, and only the latest value of each control is sent
+        const pendingInputs = {};
+        const sentInputs = {};
+        let inputFrame = 0;
+
+        function queueInput(type, id, value) {
+            pendingInputs[id] = { type: type, id: id, value: value };
+            if (!inputFrame) {
+                inputFrame = requestAnimationFrame(flushInputs);
+            }
+        }
+
+        function flushInputs() {
+            inputFrame = 0;
+            for (const id in pendingInputs) {
+                const message = pendingInputs[id];
+                delete pendingInputs[id];
+                if (sentInputs[id] === message.value) {
+                    continue;
+                }
+                sentInputs[id] = message.value;
+                sendMessage(message);
+            }
         }
 
         function sendSliderChange(id, value) {
-            webSocket.send(JSON.stringify({
-                type: 'slider_change',
-                id: id,
-                value: value
-            }));
+            queueInput('slider_change', id, value);
         }
 
         function sendTextInputChange(id, value) {
-            webSocket.send(JSON.stringify({
-                type: 'text_input_change',
-                id: id,
-                value: value
-            }));
+            queueInput('text_input_change', id, value);
         }
 
         function sendSelectChange(id, value) {
-            webSocket.send(JSON.stringify({
+            sendMessage({
                 type: 'select_change',
                 id: id,
                 value: value
-            }));
+            });
         }
     </script>
 </body>
@@ -0,0 +1,163 @@
+/**
+ * DashboardLayout.h - Declarative component tables for WebDashboard
+ *
+ * A layout is a static table of component definitions. Each entry carries
+ * the component's schema JSON, assembled at compile time from string
+ * literals, so the table, its strings and its schema all stay in flash and
+ * registering it only fills in the component slots:
+ *
+ *   static const DashboardComponentDef layout[] = {
+ *       DASHBOARD_BUTTON("reset", "Reset", onReset),
+ *       DASHBOARD_TOGGLE("pump", "Pump", false, onPump),
+ *       DASHBOARD_SLIDER("speed", "Speed", 0, 100, 50, 1, onSpeed),
+ *       DASHBOARD_TEXT_INPUT("temp", "Temperature", "0.0", NULL),
+ *       DASHBOARD_SELECT("mode", "Mode", "Auto", onMode,
+ *                        "Auto", "Manual", "Off"),
+ *   };
+ *
+ *   dashboard.addLayout(layout);
+ *
+ * Ids, labels and options must be string literals and are written into the
+ * JSON as-is, so they cannot contain quotes or backslashes. An id that does
+ * not fit in MAX_COMPONENT_ID_LENGTH fails to compile. Slider ranges must be
+ * integer literals or macros that expand to them. Pin monitors need a pin
+ * configured at runtime and are added with addPinMonitor().
+ *
+ * Included by WebDashboard.h; include that instead.
+ */
+
+#ifndef DashboardLayout_h
+#define DashboardLayout_h
+
+// Static definition of one component, see the DASHBOARD_* macros below
+struct DashboardComponentDef {
+  ComponentType type;
+  const char* id;
+  const char* label;
+  const char* schema;        // Schema JSON fragment: id, type, label, config
+  uint16_t schemaLength;
+  uint16_t idLength;         // Length of the leading "id" member in schema
+  int initialValue;          // Toggles and sliders
+  const char* initialText;   // Text inputs and selects
+  int min;                   // Sliders
+  int max;
+  int step;
+  ButtonCallback onButton;
+  ToggleCallback onToggle;
+  SliderCallback onSlider;
+  TextInputCallback onText;  // Text inputs and selects
+};
+
+#define DASHBOARD_STR_(x) #x
+#define DASHBOARD_STR(x) DASHBOARD_STR_(x)
+#define DASHBOARD_CAT_(a, b) a##b
+#define DASHBOARD_CAT(a, b) DASHBOARD_CAT_(a, b)
+
+// Comma-separated JSON strings from up to 16 string literals
+#define DASHBOARD_QUOTE_(s) "\"" s "\""
+#define DASHBOARD_JOIN_1(a) DASHBOARD_QUOTE_(a)
+#define DASHBOARD_JOIN_2(a, ...) \
+  DASHBOARD_QUOTE_(a) "," DASHBOARD_JOIN_1(__VA_ARGS__)
+#define DASHBOARD_JOIN_3(a, ...) \
+  DASHBOARD_QUOTE_(a) "," DASHBOARD_JOIN_2(__VA_ARGS__)
+#define DASHBOARD_JOIN_4(a, ...) \
+  DASHBOARD_QUOTE_(a) "," DASHBOARD_JOIN_3(__VA_ARGS__)
+#define DASHBOARD_JOIN_5(a, ...) \
+  DASHBOARD_QUOTE_(a) "," DASHBOARD_JOIN_4(__VA_ARGS__)
+#define DASHBOARD_JOIN_6(a, ...) \
+  DASHBOARD_QUOTE_(a) "," DASHBOARD_JOIN_5(__VA_ARGS__)
+#define DASHBOARD_JOIN_7(a, ...) \
+  DASHBOARD_QUOTE_(a) "," DASHBOARD_JOIN_6(__VA_ARGS__)
+#define DASHBOARD_JOIN_8(a, ...) \
+  DASHBOARD_QUOTE_(a) "," DASHBOARD_JOIN_7(__VA_ARGS__)
+#define DASHBOARD_JOIN_9(a, ...) \
+  DASHBOARD_QUOTE_(a) "," DASHBOARD_JOIN_8(__VA_ARGS__)
+#define DASHBOARD_JOIN_10(a, ...) \
+  DASHBOARD_QUOTE_(a) "," DASHBOARD_JOIN_9(__VA_ARGS__)
+#define DASHBOARD_JOIN_11(a, ...) \
+  DASHBOARD_QUOTE_(a) "," DASHBOARD_JOIN_10(__VA_ARGS__)
+#define DASHBOARD_JOIN_12(a, ...) \
+  DASHBOARD_QUOTE_(a) "," DASHBOARD_JOIN_11(__VA_ARGS__)
+#define DASHBOARD_JOIN_13(a, ...) \
+  DASHBOARD_QUOTE_(a) "," DASHBOARD_JOIN_12(__VA_ARGS__)
+#define DASHBOARD_JOIN_14(a, ...) \
+  DASHBOARD_QUOTE_(a) "," DASHBOARD_JOIN_13(__VA_ARGS__)
+#define DASHBOARD_JOIN_15(a, ...) \
+  DASHBOARD_QUOTE_(a) "," DASHBOARD_JOIN_14(__VA_ARGS__)
+#define DASHBOARD_JOIN_16(a, ...) \
+  DASHBOARD_QUOTE_(a) "," DASHBOARD_JOIN_15(__VA_ARGS__)
+#define DASHBOARD_COUNT_(_1, _2, _3, _4, _5, _6, _7, _8, _9, _10, _11, _12, \
+                         _13, _14, _15, _16, n, ...)                         \
+  n
+#define DASHBOARD_COUNT(...)                                                  \
+  DASHBOARD_COUNT_(__VA_ARGS__, 16, 15, 14, 13, 12, 11, 10, 9, 8, 7, 6, 5, 4, \
+                   3, 2, 1)
+#define DASHBOARD_JOIN(...) \
+  DASHBOARD_CAT(DASHBOARD_JOIN_, DASHBOARD_COUNT(__VA_ARGS__))(__VA_ARGS__)
+
+// Fails to compile if an id will not fit in a component slot
+template <size_t IdSize>
+struct DashboardIdFits_ {
+  static_assert(IdSize <= MAX_COMPONENT_ID_LENGTH,
+                "layout id is longer than MAX_COMPONENT_ID_LENGTH allows");
+  static const uint16_t zero = 0;
+};
+
+// The schema fragment has the same layout as the one built at runtime by
+// addX(), so clients can't tell the two apart
+#define DASHBOARD_ID_JSON_(id) "\"id\":\"" id "\""
+#define DASHBOARD_SCHEMA_(id, typeNumber, label, config) \
+  DASHBOARD_ID_JSON_(id)                                 \
+  ",\"type\":" #typeNumber ",\"label\":\"" label "\"" config
+
+#define DASHBOARD_DEF_(type, typeNumber, id, label, config, initialValue,    \
+                       initialText, min, max, step, onButton, onToggle,      \
+                       onSlider, onText)                                     \
+  {type,                                                                     \
+   id,                                                                       \
+   label,                                                                    \
+   DASHBOARD_SCHEMA_(id, typeNumber, label, config),                         \
+   sizeof(DASHBOARD_SCHEMA_(id, typeNumber, label, config)) - 1,             \
+   sizeof(DASHBOARD_ID_JSON_(id)) - 1 + DashboardIdFits_<sizeof(id)>::zero, \
+   initialValue,                                                             \
+   initialText,                                                              \
+   min,                                                                      \
+   max,                                                                      \
+   step,                                                                     \
+   onButton,                                                                 \
+   onToggle,                                                                 \
+   onSlider,                                                                 \
+   onText}
+
+// Define a button (see WebDashboard::addButton)
+#define DASHBOARD_BUTTON(id, label, callback)                                 \
+  DASHBOARD_DEF_(ComponentType::BUTTON, 1, id, label, "", 0, NULL, 0, 0, 0,   \
+                 callback, NULL, NULL, NULL)
+
+// Define a toggle (see WebDashboard::addToggle)
+#define DASHBOARD_TOGGLE(id, label, initialState, callback)                   \
+  DASHBOARD_DEF_(ComponentType::TOGGLE, 2, id, label, "", initialState, NULL, \
+                 0, 0, 0, NULL, callback, NULL, NULL)
+
+// Define a slider (see WebDashboard::addSlider)
+#define DASHBOARD_SLIDER(id, label, min, max, initialValue, step, callback) \
+  DASHBOARD_DEF_(ComponentType::SLIDER, 3, id, label,                       \
+                 ",\"config\":{\"min\":" DASHBOARD_STR(min)                 \
+                 ",\"max\":" DASHBOARD_STR(max)                             \
+                 ",\"step\":" DASHBOARD_STR(step) "}",                      \
+                 initialValue, NULL, min, max, step, NULL, NULL, callback,  \
+                 NULL)
+
+// Define a text input (see WebDashboard::addTextInput)
+#define DASHBOARD_TEXT_INPUT(id, label, initialValue, callback)              \
+  DASHBOARD_DEF_(ComponentType::TEXT_INPUT, 4, id, label, "", 0,             \
+                 initialValue, 0, 0, 0, NULL, NULL, NULL, callback)
+
+// Define a select with up to 16 options (see WebDashboard::addSelect)
+#define DASHBOARD_SELECT(id, label, initialValue, callback, ...)            \
+  DASHBOARD_DEF_(ComponentType::SELECT, 5, id, label,                       \
+                 ",\"config\":{\"options\":[" DASHBOARD_JOIN(__VA_ARGS__) \
+                 "]}",                                                      \
+                 0, initialValue, 0, 0, 0, NULL, NULL, NULL, callback)
+
+#endif  // DashboardLayout_h
@@ -0,0 +1,103 @@
+/**
+ * DashboardMessage.h - In-place parser for WebDashboard's inbound messages
+ *
+ * The page only ever sends flat JSON objects with a handful of known keys
+ * (type, id, value, schemaHash, groups), so a general JSON document is not
+ * needed to read them. DashboardMessage scans the frame once, unescapes
+ * strings inside the frame itself and points at them, and allocates
+ * nothing. The type is hashed while it is read and dispatched with a switch
+ * on hashes computed at compile time.
+ *
+ * The same keys can come as a JSON-RPC 2.0 call, whose "method" is the
+ * message type and whose "params" hold the id and value, and a frame can
+ * carry a batch of calls as a JSON array; see parseNext().
+ */
+
+#ifndef DashboardMessage_h
+#define DashboardMessage_h
+
+#include <Arduino.h>
+
+// Messages the page sends
+enum class DashboardMessageType : uint8_t {
+  UNKNOWN,
+  REQUEST_FULL_UPDATE,
+  SUBSCRIBE,
+  BUTTON_PRESS,
+  TOGGLE_CHANGE,
+  SLIDER_CHANGE,
+  TEXT_INPUT_CHANGE,
+  SELECT_CHANGE,
+  GET_VALUE  // Only as an RPC method
+};
+
+/**
+ * FNV-1a hash of a message type, usable as a case label
+ */
+constexpr uint32_t dashboardMessageHash(const char* type,
+                                        uint32_t hash = 2166136261u) {
+  return *type ? dashboardMessageHash(type + 1,
+                                      (hash ^ (uint8_t)*type) * 16777619u)
+               : hash;
+}
+
+// An inbound message. Strings point into the parsed frame and stay valid
+// as long as it does; absent strings are NULL.
+struct DashboardMessage {
+  DashboardMessageType type;
+  const char* id;
+  const char* text;  // "value" if it is a string
+  int number;        // "value" as a number: true is 1, a string is 0
+  bool flag;         // "value" as a bool: true or a non-zero number
+  const char* schemaHash;
+  int groups;        // -1 if absent
+
+  // JSON-RPC calls; id is then the one in "params"
+  bool rpc;               // "jsonrpc" was present
+  bool hasRequestId;      // false for a notification, which gets no answer
+  const char* requestId;  // The call's "id" if it is a string
+  int32_t requestNumber;  // ... if it is a number
+  bool requestNull;       // ... or null, which is answered with null
+
+  /**
+   * Parse a frame in place. Strings are unescaped and NUL-terminated inside
+   * the frame, which needn't be NUL-terminated itself.
+   *
+   * @param frame Message text; modified by parsing
+   * @param length Length of the message
+   * @return true if the frame is a JSON object. Unknown keys are skipped;
+   *         an unknown or missing type gives DashboardMessageType::UNKNOWN.
+   */
+  bool parse(char* frame, size_t length);
+
+  /**
+   * Parse the next call of a batch, a JSON array of calls, in place
+   *
+   * @param cursor Start of the batch on the first call; moved past the
+   *        parsed call. Set to NULL if the batch is malformed.
+   * @param end End of the batch
+   * @return false at the end of the batch or if it is malformed. An
+   *         element that is not an object is skipped and returned as a
+   *         message with rpc false, to be answered as an invalid request.
+   */
+  bool parseNext(char** cursor, char* end);
+
+ private:
+  char* _cursor;
+  char* _end;
+  bool _inParams;       // Reading the keys of a call's "params"
+  const char* _callId;  // Top-level "id"; the component's unless rpc
+  const char* _paramId;
+
+  void reset();
+  bool parseObject();
+  void finish();
+
+  void skipSpace();
+  char* readString(uint32_t* hash);
+  bool readValue(const char* key);
+  bool skipValue();
+  void setType(const char* type, uint32_t hash);
+};
+
+#endif  // DashboardMessage_h
@@ -0,0 +1,250 @@
+/**
+ * DashboardPool.h - Preallocated memory for WebDashboard
+ *
+ * Serialization buffers are handed out from a fixed set of size
+ * classes that are allocated once, so steady-state dashboard traffic does
+ * not allocate from the heap and cannot fragment it. Requests larger than
+ * the biggest class fall back to malloc and are counted, so a soak test can
+ * show whether the pool is sized correctly.
+ *
+ * Component ids, labels and select options live in a separate append-only
+ * string arena, since they are written once at registration and never freed.
+ * The arena grows a block at a time.
+ */
+
+#ifndef DashboardPool_h
+#define DashboardPool_h
+
+#include <Arduino.h>
+
+// Size classes: buffer size in bytes and number of buffers per class
+#ifndef POOL_SMALL_SIZE
+#define POOL_SMALL_SIZE 256
+#endif
+#ifndef POOL_SMALL_COUNT
+#define POOL_SMALL_COUNT 8
+#endif
+#ifndef POOL_MEDIUM_SIZE
+#define POOL_MEDIUM_SIZE 1024
+#endif
+#ifndef POOL_MEDIUM_COUNT
+#define POOL_MEDIUM_COUNT 4
+#endif
+#ifndef POOL_LARGE_SIZE
+#define POOL_LARGE_SIZE 8192
+#endif
+#ifndef POOL_LARGE_COUNT
+#define POOL_LARGE_COUNT 1
+#endif
+
+#define POOL_CLASS_COUNT 3
+
+// Longest number appendFloat() writes: -FLT_MAX in full with 6 decimals
+#define DASHBOARD_FLOAT_LENGTH 47
+
+// Block size of the arena holding component ids, labels and select options
+#ifndef DASHBOARD_STRING_ARENA_SIZE
+#define DASHBOARD_STRING_ARENA_SIZE 2048
+#endif
+
+// Pool usage counters
+struct DashboardPoolStats {
+  uint32_t allocations;  // Buffers served from the pool
+  uint32_t fallbacks;    // Requests that had to go to the heap
+  uint16_t inUse;        // Pool buffers currently handed out
+  uint16_t highWater;    // Most pool buffers in use at once
+};
+
+class DashboardPool {
+ public:
+  DashboardPool();
+  ~DashboardPool();
+
+  /**
+   * Allocate the backing slab (done lazily on first use otherwise)
+   *
+   * @return true if the slab is available
+   */
+  bool begin();
+
+  /**
+   * Get a buffer of at least the given size
+   *
+   * @param size Requested size in bytes
+   * @return Buffer, or NULL if neither the pool nor the heap can serve it
+   */
+  void* allocate(size_t size);
+
+  /**
+   * Return a buffer obtained from allocate() or reallocate()
+   */
+  void deallocate(void* ptr);
+
+  /**
+   * Resize a buffer, staying in place when the size class still fits
+   */
+  void* reallocate(void* ptr, size_t newSize);
+
+  /**
+   * Get the usable size of a buffer handed out by the pool
+   *
+   * @return Size class of the buffer, or 0 for heap fallbacks
+   */
+  size_t capacityOf(void* ptr);
+
+  /**
+   * Get the pool usage counters
+   */
+  DashboardPoolStats getStats();
+
+  /**
+   * Reset the allocation and fallback counters
+   */
+  void resetStats();
+
+ private:
+  struct SizeClass {
+    size_t size;
+    uint8_t count;
+    uint32_t freeMask;
+    uint8_t* base;
+  };
+
+  SizeClass _classes[POOL_CLASS_COUNT];
+  uint8_t* _slab;
+  DashboardPoolStats _stats;
+  portMUX_TYPE _lock;
+
+  SizeClass* classOf(void* ptr);
+};
+
+/**
+ * Append-only JSON frame backed by a pool buffer
+ *
+ * The buffer is taken from the pool on construction and returned when the
+ * frame goes out of scope. Appends grow the buffer through the pool if the
+ * initial size estimate was too small.
+ *
+ * A frame can also be written into storage of the caller's, such as a
+ * socket message buffer, so it needs no copy to be sent. That storage never
+ * grows: appends past its capacity are dropped and flag an overflow.
+ */
+class DashboardFrame {
+ public:
+  DashboardFrame(DashboardPool& pool, size_t capacity);
+
+  /**
+   * @param pool Pool to take a buffer from if storage is NULL
+   * @param capacity Expected length, excluding the terminator
+   * @param storage Caller's buffer of capacity + 1 bytes, or NULL
+   */
+  DashboardFrame(DashboardPool& pool, size_t capacity, char* storage);
+  ~DashboardFrame();
+
+  void append(const char* data, size_t length);
+  void append(const char* str);
+  void append(char c);
+  void append(int value);
+  void append(uint32_t value);
+
+  /**
+   * Append a float with a fixed number of decimals, at most 6 (null if not
+   * finite); never longer than DASHBOARD_FLOAT_LENGTH
+   */
+  void appendFloat(float value, uint8_t precision);
+
+  /**
+   * Append a value as a quoted JSON string, escaping as needed
+   */
+  void appendJsonString(const char* value);
+
+  /**
+   * Get the length appendJsonString() would append for a value
+   */
+  static size_t jsonStringLength(const char* value);
+
+  const char* c_str() const { return _data ? _data : ""; }
+  size_t length() const { return _length; }
+
+  /**
+   * Check whether an append was dropped because no memory was available
+   */
+  bool overflowed() const { return _overflowed; }
+
+ private:
+  DashboardFrame(const DashboardFrame&);
+  DashboardFrame& operator=(const DashboardFrame&);
+
+  bool reserve(size_t length);
+
+  DashboardPool& _pool;
+  char* _data;
+  size_t _length;
+  size_t _capacity;
+  bool _overflowed;
+  bool _fixed;  // Caller's storage, not returned to the pool
+};
+
+/**
+ * Append-only storage for component strings
+ *
+ * Strings are packed back to back from the start of a block and string lists
+ * (select options) are taken from its end. When a block is full another one
+ * is chained on, so the arena grows with the dashboard. Strings that already
+ * live in flash, such as literals, are referenced instead of copied, and a
+ * string that is already in the current block is shared.
+ */
+class DashboardStringArena {
+ public:
+  DashboardStringArena();
+  ~DashboardStringArena();
+
+  /**
+   * Get a stable copy of a string
+   *
+   * @param str String to store
+   * @param maxLength Buffer size the string is truncated to, including the
+   *                  terminator
+   * @return Stored string, or NULL if no memory is left
+   */
+  const char* intern(const char* str, size_t maxLength);
+
+  /**
+   * Get a stable copy of a list of strings
+   *
+   * @param strs Strings to store
+   * @param count Number of strings
+   * @param maxLength Buffer size each string is truncated to
+   * @return Stored list, or NULL if no memory is left
+   */
+  const char** internList(const char** strs, int count, size_t maxLength);
+
+  /**
+   * Get the number of arena bytes in use
+   */
+  size_t used() const {
+    return _retired + (_head - sizeof(char*)) + (_blockSize - _tail);
+  }
+
+  /**
+   * Get the arena size in bytes, over all blocks
+   */
+  size_t capacity() const { return _capacity; }
+
+ private:
+  DashboardStringArena(const DashboardStringArena&);
+  DashboardStringArena& operator=(const DashboardStringArena&);
+
+  bool grow();
+  const char* find(const char* str, size_t length);
+
+  // Current block; its first bytes link to the previous block
+  char* _data;
+  size_t _head;
+  size_t _tail;
+  size_t _blockSize;
+  size_t _capacity;
+  size_t _retired;  // Bytes used in earlier blocks
+};
+
+#endif  // DashboardPool_h
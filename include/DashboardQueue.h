@@ -0,0 +1,213 @@
+/**
+ * DashboardQueue.h - Prioritized outbound frames for WebDashboard
+ *
+ * Frames that can't be handed to the client sockets right away wait here, in
+ * one queue per priority class, and are drained highest class first. A
+ * machine state change or error log therefore overtakes any routine
+ * telemetry still waiting. Telemetry for a component replaces a waiting
+ * frame for the same component instead of queueing behind it, and a full
+ * telemetry queue drops its oldest frame. The other classes never drop:
+ * when full, their oldest frame goes to the sockets to make room.
+ *
+ * A waiting frame is the socket message buffer it will be sent from, so
+ * queueing copies nothing and a frame for several clients waits once per
+ * client in the same buffer. The queue owns these buffers: the socket
+ * library only counts the messages it makes from one, so each buffer also
+ * counts its holders on this side, and collect() frees it once both counts
+ * are down to zero.
+ */
+
+#ifndef DashboardQueue_h
+#define DashboardQueue_h
+
+#include <Arduino.h>
+#include <ESPAsyncWebServer.h>
+
+// Priority classes, drained in this order
+#define PRIORITY_CRITICAL 0   // Machine state changes and error logs
+#define PRIORITY_CONTROL 1    // Control echoes, added and removed components
+#define PRIORITY_TELEMETRY 2  // Value updates, batches and other logs
+#define PRIORITY_BULK 3       // Schema, state and value pages
+#define PRIORITY_COUNT 4
+
+// Frames each class holds while the sockets are busy
+#ifndef DASHBOARD_QUEUE_LENGTH
+#define DASHBOARD_QUEUE_LENGTH 16
+#endif
+
+// Counters of one priority class
+struct DashboardQueueStats {
+  uint16_t depth;           // Frames waiting now
+  uint16_t highWater;       // Most frames waiting at once
+  uint32_t sent;            // Frames handed to the sockets
+  uint32_t coalesced;       // Frames replaced by a newer one while waiting
+  uint32_t dropped;         // Frames dropped because the queue was full
+  uint32_t averageLatency;  // Mean ms from queueing to sending
+  uint32_t maxLatency;      // Longest ms from queueing to sending
+};
+
+// A socket message buffer holding one frame, made by
+// DashboardQueue::makeBuffer()
+class DashboardSocketBuffer : public AsyncWebSocketMessageBuffer {
+ public:
+  explicit DashboardSocketBuffer(size_t length)
+      : AsyncWebSocketMessageBuffer(length), _holders(1), _next(NULL) {}
+
+ private:
+  friend class DashboardQueue;
+  uint16_t _holders;            // Senders and queue entries using it
+  DashboardSocketBuffer* _next;  // In the queue's list of buffers
+};
+
+// A frame taken out of the queue, to be sent and then released
+struct DashboardQueuedFrame {
+  DashboardSocketBuffer* message;
+  size_t length;
+  uint32_t clientId;
+  uint32_t queuedAt;
+  const void* key;
+};
+
+class DashboardQueue {
+ public:
+  DashboardQueue();
+  ~DashboardQueue();
+
+  /**
+   * Make a message buffer of length bytes for a frame, held once by the
+   * caller
+   *
+   * @return NULL if there is no memory
+   */
+  DashboardSocketBuffer* makeBuffer(size_t length);
+
+  /**
+   * Hold a buffer once more, e.g. for another sender
+   */
+  void holdBuffer(DashboardSocketBuffer* buffer);
+
+  /**
+   * Let go of a buffer held by makeBuffer() or holdBuffer(). It stays until
+   * the sockets are done with it too.
+   */
+  void releaseBuffer(DashboardSocketBuffer* buffer);
+
+  /**
+   * Free the buffers nobody holds that the sockets have finished sending
+   */
+  void collect();
+
+  /**
+   * Get the number of buffers not yet freed
+   */
+  int buffers();
+
+  /**
+   * Put a frame in the queue of its class, holding its message buffer until
+   * it is released
+   *
+   * @param priority PRIORITY_* class of the frame
+   * @param clientId Client the frame is for
+   * @param message Socket message buffer holding the frame
+   * @param key Component the frame updates, or NULL. A telemetry frame
+   *            replaces a waiting one with the same key and client, and a
+   *            frame of a higher class removes it.
+   * @param overflow Set to true if the frame couldn't be queued and the
+   *                 class doesn't drop frames (any but telemetry)
+   * @return true if the frame was queued
+   */
+  bool push(uint8_t priority, uint32_t clientId,
+            DashboardSocketBuffer* message, const void* key, bool* overflow);
+
+  /**
+   * Get the client of the next frame to send
+   *
+   * @param clientId Set to the client of the oldest frame of the highest
+   *                 non-empty class
+   * @return false if nothing is waiting
+   */
+  bool peek(uint32_t* clientId);
+
+  /**
+   * Take the next frame to send; release() it once sent
+   *
+   * @return false if nothing is waiting
+   */
+  bool pop(DashboardQueuedFrame* frame);
+
+  /**
+   * Take the oldest frame of one class; release() it once sent
+   *
+   * @return false if the class is empty
+   */
+  bool popFrom(uint8_t priority, DashboardQueuedFrame* frame);
+
+  /**
+   * Let go of the message buffer of a frame taken with pop()
+   */
+  void release(DashboardQueuedFrame* frame);
+
+  /**
+   * Get the bytes of the frames waiting for one client (or ALL_CLIENTS)
+   */
+  size_t bytesFor(uint32_t clientId);
+
+  /**
+   * Drop the frames waiting for one client, e.g. after it disconnected
+   */
+  void dropFor(uint32_t clientId);
+
+  /**
+   * Count a frame that was sent without waiting
+   */
+  void countSent(uint8_t priority);
+
+  /**
+   * Get the number of frames waiting in a class and the classes above it
+   */
+  int waiting(uint8_t priority);
+
+  /**
+   * Claim the right to drain the queue, so only one task sends from it
+   *
+   * @return false if another task is already draining
+   */
+  bool beginDrain();
+  void endDrain();
+
+  /**
+   * Get the counters of each class
+   */
+  void getStats(DashboardQueueStats stats[PRIORITY_COUNT]);
+
+  /**
+   * Reset the counters; depths are kept
+   */
+  void resetStats();
+
+ private:
+  DashboardQueue(const DashboardQueue&);
+  DashboardQueue& operator=(const DashboardQueue&);
+
+  struct Ring {
+    DashboardQueuedFrame frames[DASHBOARD_QUEUE_LENGTH];
+    uint8_t head;
+    uint8_t count;
+    DashboardQueueStats stats;
+    uint32_t totalLatency;
+  };
+
+  DashboardQueuedFrame& at(Ring& ring, int i) {
+    return ring.frames[(ring.head + i) % DASHBOARD_QUEUE_LENGTH];
+  }
+  void removeAt(Ring& ring, int i);
+  void take(Ring& ring, DashboardQueuedFrame* frame);
+
+  Ring _rings[PRIORITY_COUNT];
+  DashboardSocketBuffer* _buffers;  // Every buffer not yet freed
+  int _bufferCount;
+  bool _draining;
+  portMUX_TYPE _lock;
+};
+
+#endif  // DashboardQueue_h
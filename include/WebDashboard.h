@@ -13,22 +13,132 @@
 #define WebDashboard_h
 
 #include <Arduino.h>
-#include <ArduinoJson.h>
 #include <AsyncTCP.h>
 #include <ESPAsyncWebServer.h>
 #include <WiFi.h>
 
-// Maximum number of components and clients
+#include <type_traits>
+
+#include "DashboardEvents.h"
+#include "DashboardMessage.h"
+#include "DashboardPool.h"
+#include "DashboardQueue.h"
+
+// Default capacities of WebDashboard; use BasicWebDashboard<...> to size a
+// dashboard exactly instead
+#ifndef MAX_DASHBOARD_COMPONENTS
 #define MAX_DASHBOARD_COMPONENTS 50
+#endif
+#ifndef MAX_DASHBOARD_CLIENTS
 #define MAX_DASHBOARD_CLIENTS 5
+#endif
+#ifndef MAX_LOG_ENTRIES
 #define MAX_LOG_ENTRIES 100
-#define MAX_COMPONENT_ID_LENGTH 32
+#endif
+#define MAX_COMPONENT_ID_LENGTH 32     // Longest id, including terminator
+#define MAX_COMPONENT_LABEL_LENGTH 64  // Longest label or select option
+#ifndef MAX_LOG_LENGTH
 #define MAX_LOG_LENGTH 256
+#endif
+#define MAX_VALUE_LENGTH 256  // Longest string value, including terminator
 #define MAX_LOG_RETENTION_TIME 1000 * 60 * 10  // 10 minutes
 
+// Slots added at a time once a dashboard grows past its built-in component
+// capacity (see setMaxComponents()); must be a power of two
+#ifndef DASHBOARD_COMPONENT_SEGMENT_SIZE
+#define DASHBOARD_COMPONENT_SEGMENT_SIZE 64
+#endif
+// Largest schema or state frame; bigger dashboards reach clients in pages
+#ifndef DASHBOARD_PAGE_SIZE
+#define DASHBOARD_PAGE_SIZE 4096
+#endif
+// Frames a client's socket may hold before the rest wait in the priority
+// queues (see DashboardQueue.h)
+#ifndef DASHBOARD_SOCKET_QUEUE_DEPTH
+#define DASHBOARD_SOCKET_QUEUE_DEPTH 4
+#endif
+// Slider and text input values arriving within this many ms of the last one
+// delivered for the component are coalesced; only the latest is delivered
+#ifndef DASHBOARD_INPUT_WINDOW
+#define DASHBOARD_INPUT_WINDOW 50
+#endif
+// Components that can be coalescing input at the same time
+#ifndef DASHBOARD_INPUT_SLOTS
+#define DASHBOARD_INPUT_SLOTS 4
+#endif
+// RPC calls whose value is being coalesced wait for it to be delivered
+// before they are answered; this many can wait at once
+#ifndef DASHBOARD_RPC_PENDING
+#define DASHBOARD_RPC_PENDING 8
+#endif
+// Longest string call id that can wait; calls with longer ids are answered
+// as soon as their value is stored
+#ifndef DASHBOARD_RPC_ID_LENGTH
+#define DASHBOARD_RPC_ID_LENGTH 24
+#endif
+// Inbound messages received but not yet applied by update(); a message
+// arriving while this many wait is dropped, or refused if it is an RPC call
+#ifndef DASHBOARD_INBOUND_MESSAGES
+#define DASHBOARD_INBOUND_MESSAGES 16
+#endif
+// Longest inbound message; longer ones are dropped
+#ifndef DASHBOARD_MESSAGE_MAX_SIZE
+#define DASHBOARD_MESSAGE_MAX_SIZE 4096
+#endif
+// Bytes of outbound frames that may wait for one slow client before it is
+// disconnected; see setClientBudget()
+#ifndef DASHBOARD_CLIENT_BUDGET
+#define DASHBOARD_CLIENT_BUDGET 16384
+#endif
+
 // Timeouts and intervals
 #define DASHBOARD_UPDATE_INTERVAL 500  // Update interval in ms
+#define DASHBOARD_BINDING_INTERVAL 100  // Bound variable sample interval in ms
 #define CLIENT_TIMEOUT 30000           // Client timeout in ms
+#ifndef DASHBOARD_PING_INTERVAL
+#define DASHBOARD_PING_INTERVAL 10000  // Quiet clients are pinged this often
+#endif
+// A /api/state snapshot nobody has asked for in this many ms is freed and
+// no longer kept current, until the next request
+#ifndef DASHBOARD_SNAPSHOT_TIMEOUT
+#define DASHBOARD_SNAPSHOT_TIMEOUT 60000
+#endif
+
+// Optional features. Set one to 0 in build_flags to leave its code and state
+// out of the build; the flags must be the same for every file that includes
+// this header.
+#ifndef DASHBOARD_ENABLE_LOGGING
+#define DASHBOARD_ENABLE_LOGGING 1  // Log ring and log()/logf()
+#endif
+#ifndef DASHBOARD_ENABLE_PIN_MONITORS
+#define DASHBOARD_ENABLE_PIN_MONITORS 1  // addPinMonitor() and pin polling
+#endif
+#ifndef DASHBOARD_ENABLE_CONTROLS
+#define DASHBOARD_ENABLE_CONTROLS 1  // Inbound button/toggle/slider/... events
+#endif
+#ifndef DASHBOARD_ENABLE_HTML
+#define DASHBOARD_ENABLE_HTML 1  // Serve the dashboard page at "/"
+#endif
+#ifndef DASHBOARD_ENABLE_EVENTS
+#define DASHBOARD_ENABLE_EVENTS 1  // Read-only Server-Sent Events at /events
+#endif
+#ifndef DASHBOARD_ENABLE_REST
+#define DASHBOARD_ENABLE_REST 1  // State snapshots at /api/state
+#endif
+#ifndef DASHBOARD_ENABLE_RPC
+#define DASHBOARD_ENABLE_RPC 1  // JSON-RPC calls over the WebSocket
+#endif
+
+// Features compiled into this build, usable in constant expressions
+struct DashboardFeatures {
+  static constexpr bool logging = DASHBOARD_ENABLE_LOGGING;
+  static constexpr bool pinMonitors = DASHBOARD_ENABLE_PIN_MONITORS;
+  static constexpr bool controls = DASHBOARD_ENABLE_CONTROLS;
+  static constexpr bool html = DASHBOARD_ENABLE_HTML;
+  static constexpr bool events = DASHBOARD_ENABLE_EVENTS;
+  static constexpr bool rest = DASHBOARD_ENABLE_REST;
+  static constexpr bool rpc = DASHBOARD_ENABLE_RPC;
+};
 
 // Log levels
 #define LOG_INFO 0
@@ -36,6 +146,13 @@
 #define LOG_ERROR 2
 #define LOG_DEBUG 3
 
+// Component groups, one per page tab. Each client subscribes to the groups
+// it shows and only receives value updates for those.
+#define GROUP_MONITORING 0x01  // Pin monitors
+#define GROUP_CONTROLS 0x02    // Buttons
+#define GROUP_SETTINGS 0x04    // Toggles, sliders, text inputs and selects
+#define GROUP_ALL 0x07
+
 // Component types
 enum class ComponentType {
   BUTTON = 1,
@@ -47,6 +164,97 @@ enum class ComponentType {
   MACHINE_STATE = 7
 };
 
+// Kind of value a component currently holds
+enum class ValueType : uint8_t {
+  NONE = 0,
+  INT = 1,
+  FLOAT = 2,
+  BOOL = 3,
+  STRING = 4
+};
+
+// Source of a bound component value
+enum class BindingType : uint8_t {
+  NONE = 0,
+  INT = 1,
+  FLOAT = 2,
+  BOOL = 3,
+  INT_GETTER = 4,
+  FLOAT_GETTER = 5,
+  BOOL_GETTER = 6
+};
+
+/**
+ * Lightweight reference to a registered component
+ *
+ * Returned by the addX methods. The index addresses the component slot
+ * directly, and the generation tells a live slot apart from one that has
+ * been reused. The component type is part of the handle type, so passing a
+ * value of the wrong kind to updateValue() fails to compile.
+ */
+template <ComponentType T>
+struct ComponentHandle {
+  int16_t index;
+  uint16_t generation;
+
+  ComponentHandle() : index(-1), generation(0) {}
+  ComponentHandle(int16_t index, uint16_t generation)
+      : index(index), generation(generation) {}
+
+  bool isValid() const { return index >= 0; }
+  operator bool() const { return isValid(); }
+};
+
+typedef ComponentHandle<ComponentType::BUTTON> ButtonHandle;
+typedef ComponentHandle<ComponentType::TOGGLE> ToggleHandle;
+typedef ComponentHandle<ComponentType::SLIDER> SliderHandle;
+typedef ComponentHandle<ComponentType::TEXT_INPUT> TextInputHandle;
+typedef ComponentHandle<ComponentType::SELECT> SelectHandle;
+typedef ComponentHandle<ComponentType::PIN_MONITOR> PinMonitorHandle;
+
+// Runtime counters, see WebDashboard::getStats()
+struct DashboardStats {
+  uint32_t updatesSent;        // Value changes published to clients
+  uint32_t updatesSuppressed;  // Updates skipped because nothing changed
+  uint32_t updatesUnwatched;   // Updates no client was subscribed to
+  uint32_t inputsReceived;     // Slider and text input events from clients
+  uint32_t inputsCoalesced;    // Input events replaced by a later value
+  uint32_t messagesReassembled;  // Inbound messages that arrived in pieces
+  uint32_t messagesDropped;      // ... too large or from untracked clients
+  uint32_t clientsTimedOut;      // Clients closed for not answering pings
+  uint32_t clientsEvicted;       // Clients closed for exceeding their budget
+  uint32_t stateRequests;     // Requests for /api/state and /api/state/{id}
+  uint32_t stateNotModified;  // ... answered 304 from the ETag alone
+  uint32_t stateSnapshots;    // Times the /api/state body was serialized
+  uint32_t rpcCalls;   // JSON-RPC calls received, batched ones included
+  uint32_t rpcErrors;  // ... answered with an error
+  uint32_t rpcHeld;    // ... answered once their value was delivered
+  uint32_t socketFrames;       // Frames put in a socket message buffer
+  uint32_t socketBytesCopied;  // ... bytes copied there after serializing
+  uint16_t socketBuffers;      // Socket message buffers not yet freed
+  uint32_t poolAllocations;    // Frame buffers served by the pool
+  uint32_t poolFallbacks;      // Buffers that had to come from the heap
+  uint16_t poolInUse;          // Pool buffers currently handed out
+  uint16_t poolHighWater;      // Most pool buffers in use at once
+  uint32_t freeHeap;           // Free heap at the time of getStats()
+  uint32_t minFreeHeap;        // Lowest free heap since boot
+  uint32_t largestFreeBlock;   // Largest allocatable heap block
+  uint8_t fragmentation;       // 100 - largest block as % of free heap
+  uint32_t componentBytes;     // Component slots, built-in and segments
+  uint32_t indexBytes;         // Id lookup table
+  uint32_t stringBytes;        // Ids, labels and options in the string arena
+  uint32_t fragmentBytes;      // Cached JSON fragments and string values
+  DashboardQueueStats queues[PRIORITY_COUNT];  // By PRIORITY_* class
+  DashboardEventStats events;  // Viewers of /events
+};
+
+// Value categories accepted by the handle-based updateValue() overloads
+template <typename V>
+struct IsDashboardInteger {
+  static const bool value =
+      std::is_integral<V>::value && !std::is_same<V, bool>::value;
+};
+
 // Callback function types
 typedef void (*ButtonCallback)(const char* id);
 typedef void (*ToggleCallback)(const char* id, bool state);
@@ -56,15 +264,32 @@ typedef void (*SelectCallback)(const char* id, const char* value);
 typedef void (*StateChangeCallback)(const char* oldState, const char* newState);
 typedef void (*WebClientConnectCallback)(const char* clientIp);
 
-class WebDashboard {
+// Getter function types for bound values
+typedef int (*IntGetter)();
+typedef float (*FloatGetter)();
+typedef bool (*BoolGetter)();
+
+#include "DashboardLayout.h"
+
+/**
+ * Dashboard logic, independent of capacity
+ *
+ * Component, client and log storage is provided by BasicWebDashboard, so the
+ * same code serves every capacity. Use WebDashboard or BasicWebDashboard<...>
+ * to create a dashboard, and WebDashboardBase& to pass one around.
+ */
+class WebDashboardBase {
  public:
   // Component tracking
   struct DashboardComponent {
-    char id[MAX_COMPONENT_ID_LENGTH];
+    // Strings are stored in the dashboard's string arena, or point straight
+    // at flash when they were passed as literals
+    const char* id;
     ComponentType type;
     bool active;
+    uint16_t generation;
     void* callback;
-    char label[64];
+    const char* label;
     union {
       struct {
         int min;
@@ -72,9 +297,10 @@ class WebDashboard {
         int step;
       } slider;
       struct {
-        char** options;
+        const char** options;
         int optionCount;
       } select;
+#if DASHBOARD_ENABLE_PIN_MONITORS
       struct {
         uint8_t pin;
         uint8_t mode;
@@ -82,14 +308,127 @@ class WebDashboard {
         uint32_t lastUpdate;
         bool isAnalog;
       } pinMonitor;
+#endif
+      int nextFree;  // Removed slots: next slot on the free list, or -1
     } config;
-    DynamicJsonDocument* data;
+    struct {
+      ValueType type;
+      uint8_t precision;
+      uint16_t capacity;
+      char* text;
+      union {
+        int intValue;
+        float floatValue;
+        bool boolValue;
+      };
+    } value;
+    struct {
+      BindingType type;
+      uint8_t precision;
+      portMUX_TYPE* lock;
+      union {
+        const int* intValue;
+        const float* floatValue;
+        const bool* boolValue;
+        IntGetter intGetter;
+        FloatGetter floatGetter;
+        BoolGetter boolGetter;
+      } source;
+    } binding;
+
+    // Cached JSON fragments: the static part is built once at registration,
+    // the value part again only after the value changes. Components added
+    // from a layout point straight at the schema in flash instead.
+    const char* schemaJson;
+    char* valueJson;
+    uint16_t schemaLength;
+    uint16_t idLength;
+    uint16_t valueLength;
+    uint16_t valueCapacity;
+    bool valueDirty;
+    bool pending;
+    bool schemaStatic;
   };
 
-  /**
-   * Constructor for WebDashboard
-   */
-  WebDashboard();
+  // Client tracking
+  struct WebClient {
+    uint32_t id;
+    IPAddress ip;
+    uint32_t lastSeen;  // Last message or pong
+    uint32_t lastPing;
+    bool active;     // Heard from within CLIENT_TIMEOUT
+    bool connected;  // Slot in use; free slots are taken by new clients
+    uint8_t groups;  // GROUP_* the client is subscribed to
+    // Progress of the schema, state or value pages still to be sent
+    uint8_t syncStage;
+    uint8_t syncGroups;
+    uint16_t syncOffset;
+    uint32_t syncHash;
+    // Message arriving in pieces, in a pool buffer while it is incomplete
+    char* partial;
+    uint16_t partialLength;
+    uint16_t partialCapacity;
+    bool receiving;   // Between the first and the last piece of a message
+    bool discarding;  // ... of one that is too large to keep
+  };
+
+#if DASHBOARD_ENABLE_EVENTS
+  // Schema and state pages still to be sent to a viewer of /events
+  struct EventViewer {
+    uint32_t id;  // 0 when the slot is free
+    uint8_t syncStage;
+    uint16_t syncOffset;
+    uint32_t syncHash;
+  };
+#endif
+
+#if DASHBOARD_ENABLE_REST
+  // A /api/state request that arrived before the first snapshot
+  struct StateWait {
+    String id;
+    String body;  // Copied from the snapshot once there is one
+    bool ready;
+  };
+#endif
+
+#if DASHBOARD_ENABLE_CONTROLS
+  // A control a client is changing, coalesced over DASHBOARD_INPUT_WINDOW
+  struct InputSlot {
+    int index;  // Component slot, or -1 if unused
+    uint16_t generation;
+    uint32_t clientId;      // Client that sent the latest value
+    uint32_t deliveredAt;   // When a value was last delivered
+    bool pending;           // A value arrived since then
+    bool changed;           // ... and it differs from the delivered one
+  };
+#endif
+
+#if DASHBOARD_ENABLE_RPC && DASHBOARD_ENABLE_CONTROLS
+  // A call answered once the value it set has been delivered
+  struct HeldCall {
+    uint32_t clientId;  // 0 when the slot is free
+    int index;          // Component slot
+    uint16_t generation;
+    bool textId;                         // The call's id is a string
+    bool nullId;                         // ... or null
+    int32_t number;                      // Its id if it is a number
+    char text[DASHBOARD_RPC_ID_LENGTH];  // ... if it is a string
+  };
+#endif
+
+  // A message waiting for update() to apply it
+  struct InboundMessage {
+    uint32_t clientId;
+    char* text;  // From the pool, owned by the queue
+    size_t length;
+  };
+
+  // Log storage; the message text is kept in a separate buffer
+  struct LogEntry {
+    uint8_t level;
+    uint32_t timestamp;
+    bool active;
+  };
 
   /**
    * Initialize the web dashboard
@@ -123,11 +462,78 @@ class WebDashboard {
    */
   const char* getMachineState();
 
+  /**
+   * Get the revision of the dashboard's state. It goes up with every value,
+   * machine state and component change, and is part of the ETag of
+   * /api/state.
+   */
+  uint32_t getRevision();
+
   /**
    * Register a callback for machine state changes
    */
   void onStateChange(StateChangeCallback callback);
 
+  /**
+   * Register a callback for browsers connecting
+   */
+  void onClientConnect(WebClientConnectCallback callback);
+
+  /**
+   * Get the number of browsers connected now, including any beyond the
+   * tracked client capacity
+   */
+  int getClientCount();
+
+  /**
+   * Set how many bytes of outbound frames may wait for one client. A client
+   * that falls further behind is disconnected and reloads its state when
+   * the page reconnects.
+   *
+   * @param bytes Budget per client (default: DASHBOARD_CLIENT_BUDGET)
+   */
+  void setClientBudget(size_t bytes);
+
+  /**
+   * Let the dashboard grow past its built-in component capacity
+   *
+   * By default a dashboard holds exactly the number of components it was
+   * declared with. Above that, slots are allocated from the heap (PSRAM when
+   * available) DASHBOARD_COMPONENT_SEGMENT_SIZE at a time as components are
+   * added. Slots never move, so handles stay valid.
+   *
+   * @param maxComponents Largest number of components (up to 32767)
+   * @return true if the limit was accepted
+   */
+  bool setMaxComponents(int maxComponents);
+
+  /**
+   * Get the number of components on the dashboard
+   */
+  int getComponentCount();
+
+  /**
+   * Remove a component
+   *
+   * Clients drop the component without a full update. Its slot is reused by
+   * the next component added, and handles to it become invalid.
+   *
+   * @param id Unique identifier of the component
+   * @return true if the component was found
+   */
+  bool removeComponent(const char* id);
+
+  /**
+   * Remove a component by handle
+   *
+   * @param handle Handle returned by one of the addX() methods
+   * @return true if the handle was still valid
+   */
+  template <ComponentType T>
+  bool removeComponent(ComponentHandle<T> handle) {
+    return deleteComponent(resolve(handle));
+  }
+
   // ==================== Controls API ====================
 
   /**
@@ -136,9 +542,10 @@ class WebDashboard {
    * @param id Unique identifier for the button
    * @param label Text to display on the button
    * @param callback Function to call when button is pressed
-   * @return true if successful
+   * @return Handle to the button (invalid if the dashboard is full)
    */
-  bool addButton(const char* id, const char* label, ButtonCallback callback);
+  ButtonHandle addButton(const char* id, const char* label,
+                         ButtonCallback callback);
 
   // ==================== Settings API ====================
 
@@ -149,10 +556,10 @@ class WebDashboard {
    * @param label Text to display next to the toggle
    * @param initialState Initial state (true = on, false = off)
    * @param callback Function to call when toggle changes
-   * @return true if successful
+   * @return Handle to the toggle (invalid if the dashboard is full)
    */
-  bool addToggle(const char* id, const char* label, bool initialState,
-                 ToggleCallback callback);
+  ToggleHandle addToggle(const char* id, const char* label, bool initialState,
+                         ToggleCallback callback);
 
   /**
    * Add a slider setting
@@ -164,11 +571,11 @@ class WebDashboard {
    * @param step Step size (default: 1)
    * @param initialValue Initial value
    * @param callback Function to call when slider changes
-   * @return true if successful
+   * @return Handle to the slider (invalid if the dashboard is full)
    */
-  bool addSlider(const char* id, const char* label, int min, int max,
-                 int initialValue, int step = 1,
-                 SliderCallback callback = NULL);
+  SliderHandle addSlider(const char* id, const char* label, int min, int max,
+                         int initialValue, int step = 1,
+                         SliderCallback callback = NULL);
 
   /**
    * Add a text input setting
@@ -177,10 +584,11 @@ class WebDashboard {
    * @param label Text to display next to the input
    * @param initialValue Initial value
    * @param callback Function to call when input changes
-   * @return true if successful
+   * @return Handle to the input (invalid if the dashboard is full)
    */
-  bool addTextInput(const char* id, const char* label, const char* initialValue,
-                    TextInputCallback callback = NULL);
+  TextInputHandle addTextInput(const char* id, const char* label,
+                               const char* initialValue,
+                               TextInputCallback callback = NULL);
 
   /**
    * Add a select/dropdown setting
@@ -191,11 +599,12 @@ class WebDashboard {
    * @param optionCount Number of options
    * @param initialValue Initial selected option
    * @param callback Function to call when selection changes
-   * @return true if successful
+   * @return Handle to the select (invalid if the dashboard is full)
    */
-  bool addSelect(const char* id, const char* label, const char** options,
-                 int optionCount, const char* initialValue,
-                 SelectCallback callback = NULL);
+  SelectHandle addSelect(const char* id, const char* label,
+                         const char** options, int optionCount,
+                         const char* initialValue,
+                         SelectCallback callback = NULL);
 
   // ==================== Monitoring API ====================
 
@@ -208,11 +617,22 @@ class WebDashboard {
    * @param mode Pin mode (INPUT, INPUT_PULLUP, etc.)
    * @param isAnalog Whether to read as analog or digital
    * @param updateInterval How often to update (in ms)
-   * @return true if successful
+   * @return Handle to the pin monitor (invalid if the dashboard is full)
    */
-  bool addPinMonitor(const char* id, const char* label, uint8_t pin,
-                     uint8_t mode, bool isAnalog = false,
-                     uint32_t updateInterval = 100);
+#if DASHBOARD_ENABLE_PIN_MONITORS
+  PinMonitorHandle addPinMonitor(const char* id, const char* label,
+                                 uint8_t pin, uint8_t mode,
+                                 bool isAnalog = false,
+                                 uint32_t updateInterval = 100);
+#else
+  // Pin monitors are compiled out: always returns an invalid handle
+  PinMonitorHandle addPinMonitor(const char* id, const char* label,
+                                 uint8_t pin, uint8_t mode,
+                                 bool isAnalog = false,
+                                 uint32_t updateInterval = 100) {
+    return PinMonitorHandle();
+  }
+#endif
 
   /**
    * Log a message to the dashboard
@@ -221,7 +641,12 @@ class WebDashboard {
    * @param level Log level (0=info, 1=warning, 2=error, 3=debug)
    * @return true if successful
    */
+#if DASHBOARD_ENABLE_LOGGING
   bool log(const char* message, uint8_t level = LOG_INFO);
+#else
+  // Logging is compiled out: messages are dropped
+  bool log(const char* message, uint8_t level = LOG_INFO) { return false; }
+#endif
 
   /**
    * Log a formatted message (printf style)
@@ -231,7 +656,11 @@ class WebDashboard {
    * @param ... Variable arguments for format string
    * @return true if successful
    */
+#if DASHBOARD_ENABLE_LOGGING
   bool logf(uint8_t level, const char* format, ...);
+#else
+  bool logf(uint8_t level, const char* format, ...) { return false; }
+#endif
 
   /**
    * Update a component's value
@@ -270,6 +699,242 @@ class WebDashboard {
    */
   bool updateValue(const char* id, bool value);
 
+  // ==================== Layout API ====================
+
+  /**
+   * Add every component of a static layout (see DashboardLayout.h)
+   *
+   * The components keep pointing at the layout's strings and schema, so the
+   * layout must stay alive as long as the dashboard; declare it static const.
+   *
+   * @param layout Component definitions, in display order
+   * @param count Number of definitions
+   * @return true if every component was added
+   */
+  bool addLayout(const DashboardComponentDef* layout, int count);
+
+  /**
+   * Add every component of a static layout array
+   */
+  template <size_t N>
+  bool addLayout(const DashboardComponentDef (&layout)[N]) {
+    return addLayout(layout, (int)N);
+  }
+
+  // ==================== Batch API ====================
+
+  /**
+   * Start a batch of updates
+   *
+   * Until the matching commit(), updateValue() and setMachineState() change
+   * the stored state but do not broadcast. Batches may be nested; only the
+   * outermost commit() sends.
+   */
+  void beginBatch();
+
+  /**
+   * Close a batch and broadcast all changes made inside it as one frame
+   *
+   * @return true if a batch was open
+   */
+  bool commit();
+
+  /**
+   * Check whether a batch is currently open
+   */
+  bool isBatching();
+
+  // ==================== Handle API ====================
+  //
+  // These overloads address the component slot directly through the handle
+  // returned by addX, skipping the id lookup. Only values matching the
+  // component type are accepted; anything else is a compile error.
+
+  /**
+   * Update a toggle's state
+   *
+   * @param handle Handle returned by addToggle()
+   * @param value New state
+   * @return true if the handle is still valid
+   */
+  template <typename V>
+  typename std::enable_if<std::is_same<V, bool>::value, bool>::type
+  updateValue(ToggleHandle handle, V value) {
+    return setValue(resolve(handle), (bool)value);
+  }
+
+  /**
+   * Update a slider's value
+   *
+   * @param handle Handle returned by addSlider()
+   * @param value New value (any integer type)
+   * @return true if the handle is still valid
+   */
+  template <typename V>
+  typename std::enable_if<IsDashboardInteger<V>::value, bool>::type
+  updateValue(SliderHandle handle, V value) {
+    return setValue(resolve(handle), (int)value);
+  }
+
+  /**
+   * Update a pin monitor's displayed value
+   *
+   * @param handle Handle returned by addPinMonitor()
+   * @param value New value (any integer type)
+   * @return true if the handle is still valid
+   */
+  template <typename V>
+  typename std::enable_if<IsDashboardInteger<V>::value, bool>::type
+  updateValue(PinMonitorHandle handle, V value) {
+    return setValue(resolve(handle), (int)value);
+  }
+
+  /**
+   * Update a text input with an integer value
+   *
+   * @param handle Handle returned by addTextInput()
+   * @param value New value (any integer type)
+   * @return true if the handle is still valid
+   */
+  template <typename V>
+  typename std::enable_if<IsDashboardInteger<V>::value, bool>::type
+  updateValue(TextInputHandle handle, V value) {
+    return setValue(resolve(handle), (int)value);
+  }
+
+  /**
+   * Update a text input with a floating point value
+   *
+   * @param handle Handle returned by addTextInput()
+   * @param value New value (float or double)
+   * @param precision Number of decimal places
+   * @return true if the handle is still valid
+   */
+  template <typename V>
+  typename std::enable_if<std::is_floating_point<V>::value, bool>::type
+  updateValue(TextInputHandle handle, V value, int precision = 2) {
+    return setValue(resolve(handle), (float)value, precision);
+  }
+
+  /**
+   * Update a text input with a string value
+   *
+   * @param handle Handle returned by addTextInput()
+   * @param value New value
+   * @return true if the handle is still valid
+   */
+  bool updateValue(TextInputHandle handle, const char* value) {
+    return setValue(resolve(handle), value);
+  }
+
+  /**
+   * Update a select's current option
+   *
+   * @param handle Handle returned by addSelect()
+   * @param value New selected option
+   * @return true if the handle is still valid
+   */
+  bool updateValue(SelectHandle handle, const char* value) {
+    return setValue(resolve(handle), value);
+  }
+
+  // ==================== Binding API ====================
+
+  /**
+   * Bind a component to an integer variable
+   *
+   * The variable is sampled every binding interval and changed values are
+   * published in batched frames, so no updateValue() call is needed.
+   *
+   * @param id Unique identifier of the component
+   * @param value Pointer to the variable (must outlive the binding)
+   * @param lock Spinlock taken around each read when the variable is written
+   *             from another task (optional)
+   * @return true if successful
+   */
+  bool bindValue(const char* id, const int* value, portMUX_TYPE* lock = NULL);
+
+  /**
+   * Bind a component to a float variable
+   *
+   * @param id Unique identifier of the component
+   * @param value Pointer to the variable (must outlive the binding)
+   * @param precision Number of decimal places
+   * @param lock Spinlock taken around each read (optional)
+   * @return true if successful
+   */
+  bool bindValue(const char* id, const float* value, int precision = 2,
+                 portMUX_TYPE* lock = NULL);
+
+  /**
+   * Bind a component to a boolean variable
+   *
+   * @param id Unique identifier of the component
+   * @param value Pointer to the variable (must outlive the binding)
+   * @param lock Spinlock taken around each read (optional)
+   * @return true if successful
+   */
+  bool bindValue(const char* id, const bool* value, portMUX_TYPE* lock = NULL);
+
+  /**
+   * Bind a component to an integer getter function
+   *
+   * @param id Unique identifier of the component
+   * @param getter Function returning the current value
+   * @return true if successful
+   */
+  bool bindValue(const char* id, IntGetter getter);
+
+  /**
+   * Bind a component to a float getter function
+   *
+   * @param id Unique identifier of the component
+   * @param getter Function returning the current value
+   * @param precision Number of decimal places
+   * @return true if successful
+   */
+  bool bindValue(const char* id, FloatGetter getter, int precision = 2);
+
+  /**
+   * Bind a component to a boolean getter function
+   *
+   * @param id Unique identifier of the component
+   * @param getter Function returning the current value
+   * @return true if successful
+   */
+  bool bindValue(const char* id, BoolGetter getter);
+
+  /**
+   * Remove the binding from a component
+   *
+   * @param id Unique identifier of the component
+   * @return true if the component was bound
+   */
+  bool unbindValue(const char* id);
+
+  /**
+   * Set how often bound variables are sampled
+   *
+   * @param interval Sample interval in ms (default: DASHBOARD_BINDING_INTERVAL)
+   */
+  void setBindingInterval(uint32_t interval);
+
+  /**
+   * Get the update, buffer pool and heap counters
+   *
+   * Every updateValue() either publishes a change or is suppressed because
+   * the value is unchanged (floats compare by the value they display).
+   * Frames are serialized into buffers from a fixed pool; a growing
+   * poolFallbacks count means the POOL_* sizes are too small.
+   * The memory fields break down what the components occupy in RAM.
+   */
+  const DashboardStats& getStats();
+
+  /**
+   * Reset the update and pool counters to zero
+   */
+  void resetStats();
+
   /**
    * Check if the dashboard is online
    */
@@ -285,12 +950,70 @@ class WebDashboard {
    */
   bool isDebugLoggingEnabled();
 
+ protected:
+  /**
+   * Constructor, called by BasicWebDashboard with its storage
+   *
+   * @param components Component slots
+   * @param componentCapacity Number of component slots
+   * @param clients Client slots
+   * @param clientCapacity Number of client slots
+   * @param logEntries Log entry slots
+   * @param logText Message buffer, logCapacity * logLength bytes
+   * @param logCapacity Number of log entry slots
+   * @param logLength Size of each log message, including terminator
+   */
+  WebDashboardBase(DashboardComponent* components, int componentCapacity,
+                   WebClient* clients, int clientCapacity,
+                   LogEntry* logEntries, char* logText, int logCapacity,
+                   int logLength);
+
+ public:
+  /**
+   * Release the component segments, id index and cached fragments
+   *
+   * Dashboards normally live as long as the program. The web server is not
+   * torn down, so only destroy a dashboard that was never started.
+   */
+  ~WebDashboardBase();
+
  private:
+  // Client id used by the send helpers to address every client
+  static const uint32_t ALL_CLIENTS = 0;
+
+  // Pages a client is still waiting for, see WebClient::syncStage
+  enum SyncStage : uint8_t {
+    SYNC_IDLE = 0,
+    SYNC_SCHEMA = 1,
+    SYNC_STATE = 2,
+    SYNC_VALUES = 3  // Current values of newly subscribed groups
+  };
+
+  // What became of an inbound message, as answered to an RPC call
+  enum MessageOutcome : uint8_t {
+    MESSAGE_APPLIED = 0,
+    MESSAGE_HELD = 1,       // Coalesced; answered when it is delivered
+    MESSAGE_UNKNOWN = 2,    // No such message type, or compiled out
+    MESSAGE_INVALID = 3,    // No such component, or one of another type
+    MESSAGE_UNANSWERED = 4  // A notification, or a call answered later
+  };
+
   bool _isInitialized;
   bool _debugLoggingEnabled;
   char _dashboardTitle[64];
   char _machineState[64];
+  bool _machineStatePending;
+  bool _schemaHashValid;
+  uint32_t _schemaHash;
+  uint8_t _batchDepth;
   uint32_t _lastUpdate;
+  uint32_t _lastBindingSample;
+  uint32_t _bindingInterval;
+  DashboardStats _stats;
+  uint32_t _revision;  // Goes up with every value, state and schema change
+  DashboardPool _pool;
+  DashboardQueue _queue;
+  DashboardStringArena _strings;
   IPAddress _ipAddress;
   StateChangeCallback _stateChangeCallback;
 
@@ -298,44 +1021,311 @@ class WebDashboard {
   AsyncWebServer* _server;
   AsyncWebSocket* _ws;
 
-  // Component tracking
-  DashboardComponent _components[MAX_DASHBOARD_COMPONENTS];
+  // Component tracking. Slots below _componentCapacity are the built-in
+  // storage, the ones above live in heap segments.
+  DashboardComponent* _components;
+  int _componentCapacity;
+  DashboardComponent** _segments;
+  int _segmentCount;
+  int _maxComponents;
   int _componentCount;
+  int _freeList;   // Most recently removed slot, or -1
+  int _freeCount;
+  int _pendingCount;
+  int _bindingCount;
+  int _pinMonitorCount;
 
-  // Client tracking
-  struct WebClient {
-    uint32_t id;
-    IPAddress ip;
-    uint32_t lastSeen;
-    bool active;
-  };
+  // Open-addressed hash table from id to slot; entries hold slot + 1
+  uint16_t* _idIndex;
+  int _idIndexSize;
+  int _idIndexCount;
 
-  WebClient _clients[MAX_DASHBOARD_CLIENTS];
+  // Client tracking
+  WebClient* _clients;
+  int _clientCapacity;
   int _clientCount;
   WebClientConnectCallback _clientConnectCallback;
+  size_t _clientBudget;
 
-  // Log storage
-  struct LogEntry {
-    char message[MAX_LOG_LENGTH];
-    uint8_t level;
-    uint32_t timestamp;
-    bool active;
-  };
+  // Received in order on the web server's task, applied by update();
+  // guarded by _inboundLock
+  InboundMessage _inbound[DASHBOARD_INBOUND_MESSAGES];
+  uint16_t _inboundHead;
+  uint16_t _inboundCount;
+  portMUX_TYPE _inboundLock;
+
+#if DASHBOARD_ENABLE_EVENTS
+  // Read-only viewers, indexed by the slot in their id
+  DashboardEvents _events;
+  EventViewer _viewers[DASHBOARD_EVENT_VIEWERS];
+#endif
+
+#if DASHBOARD_ENABLE_REST
+  // Body of /api/state, serialized by update() and only read by the web
+  // server; the pointer, revision and readers are guarded by _snapshotLock
+  char* _snapshot;
+  uint32_t _snapshotRevision;
+  uint32_t _lastSnapshot;    // When update() last serialized one
+  uint8_t _snapshotReaders;  // Requests copying from _snapshot right now
+  bool _snapshotPolled;      // Someone asked lately, so keep it current
+  uint32_t _lastPoll;        // When a request last asked for it
+  uint32_t _stateEpoch;  // Tells this boot's ETags from an earlier boot's
+  portMUX_TYPE _snapshotLock;
+#endif
+
+#if DASHBOARD_ENABLE_CONTROLS
+  InputSlot _inputs[DASHBOARD_INPUT_SLOTS];
+  portMUX_TYPE _inputLock;
+#endif
+#if DASHBOARD_ENABLE_RPC && DASHBOARD_ENABLE_CONTROLS
+  HeldCall _heldCalls[DASHBOARD_RPC_PENDING];  // Guarded by _inputLock
+#endif
 
-  LogEntry _logEntries[MAX_LOG_ENTRIES];
+#if DASHBOARD_ENABLE_LOGGING
+  // Log storage
+  LogEntry* _logEntries;
+  char* _logText;
+  int _logCapacity;
+  int _logLength;
   int _logEntryCount;
   int _logEntryIndex;
+#endif
+
+  WebDashboardBase(const WebDashboardBase&);
+  WebDashboardBase& operator=(const WebDashboardBase&);
 
   // Internal helper methods
   void handleWebSocketEvent(AsyncWebSocket* server,
                             AsyncWebSocketClient* client, AwsEventType type,
                             void* arg, uint8_t* data, size_t len);
-  void processWebSocketMessage(uint32_t clientId, const char* message);
-  void broadcastDashboardUpdate(bool fullUpdate = false);
-  void broadcastComponentUpdate(const char* componentId);
+  void receivePiece(uint32_t clientId, AwsFrameInfo* info, uint8_t* data,
+                    size_t len);
+  void releasePartial(WebClient* client);
+  void serviceClients();
+  void queueMessage(uint32_t clientId, char* text, size_t length);
+  void serviceMessages();
+  void processWebSocketMessage(uint32_t clientId, char* message,
+                               size_t length);
+  uint8_t applyMessage(uint32_t clientId, const DashboardMessage& msg,
+                       DashboardComponent** target);
+#if DASHBOARD_ENABLE_RPC
+  void handleBatch(uint32_t clientId, char* batch, char* end);
+  uint8_t handleCall(uint32_t clientId, const DashboardMessage& call,
+                     DashboardComponent** target);
+  void appendResponse(DashboardFrame& out, const char* requestId,
+                      int32_t requestNumber, bool requestNull,
+                      DashboardComponent* comp,
+                      uint8_t outcome);
+#endif
+  void handleFullUpdateRequest(uint32_t clientId, const char* clientHash);
+  void handleSubscribe(uint32_t clientId, uint8_t groups);
+#if DASHBOARD_ENABLE_CONTROLS
+  bool handleInput(uint32_t clientId, DashboardComponent* comp,
+                   bool changed, const DashboardMessage* call = NULL);
+  void deliverInput(uint32_t clientId, DashboardComponent* comp,
+                    bool changed);
+  void serviceInputs();
+#endif
+#if DASHBOARD_ENABLE_RPC && DASHBOARD_ENABLE_CONTROLS
+  bool holdCall(int index, uint16_t generation, uint32_t clientId,
+                const DashboardMessage& call);
+  void answerHeldCalls(int index, uint16_t generation,
+                       DashboardComponent* comp);
+  void dropHeldCalls(uint32_t clientId);
+#endif
+  void serviceSync();
+  void sendSyncPage(uint32_t clientId, uint8_t* stage, uint8_t groups,
+                    uint16_t* offset, uint32_t* hash);
+#if DASHBOARD_ENABLE_EVENTS
+  void handleEventRequest(AsyncWebServerRequest* request);
+#endif
+#if DASHBOARD_ENABLE_REST
+  void handleStateRequest(AsyncWebServerRequest* request);
+  int copySnapshot(const char* snapshot, const char* id, String& body);
+  size_t fillState(StateWait* wait, uint8_t* buffer, size_t maxLength,
+                   size_t index);
+  void serviceSnapshot();
+  bool buildSnapshot(uint32_t revision);
+#endif
+  int sendSchema(uint32_t clientId, int offset);
+  int sendState(uint32_t clientId, int offset);
+  int sendValues(uint32_t clientId, uint8_t groups, int offset);
+  void sendFrame(uint32_t clientId, const DashboardFrame& frame,
+                 uint8_t priority, const void* key = NULL,
+                 DashboardSocketBuffer* message = NULL);
+  void sendToGroups(uint8_t groups, const DashboardFrame& frame,
+                    uint8_t priority, const void* key = NULL,
+                    uint32_t except = 0,
+                    DashboardSocketBuffer* message = NULL);
+  bool clientReady(uint32_t clientId);
+  void transmit(uint32_t clientId, AsyncWebSocketMessageBuffer* message);
+  DashboardSocketBuffer* makeMessage(size_t length);
+  DashboardSocketBuffer* shareFrame(
+      const DashboardFrame& frame, DashboardSocketBuffer* message);
+  void releaseMessage(DashboardSocketBuffer* message);
+  static char* storageOf(DashboardSocketBuffer* message) {
+    return message ? (char*)message->get() : NULL;
+  }
+  void drainQueue();
+  uint8_t subscribedGroups();
+  bool hasUntrackedClients();
+  static uint8_t groupOf(DashboardComponent* comp);
+  uint32_t schemaHash();
+  void broadcastComponentAdded(DashboardComponent* comp);
+  void broadcastComponentUpdate(DashboardComponent* comp,
+                                uint8_t priority = PRIORITY_TELEMETRY,
+                                uint32_t except = 0);
+  void broadcastComponentRemoved(const char* id);
+  void broadcastPendingComponents();
+  void sendPendingComponents(uint8_t groups, bool everyone);
+  void broadcastMachineState();
+  void appendComponent(DashboardFrame& out, DashboardComponent* comp);
+  size_t componentLength(DashboardComponent* comp);
+  void appendComponentValue(DashboardFrame& out,
+                            DashboardComponent* comp);
+  size_t valueLength(DashboardComponent* comp);
+  void buildSchemaFragment(DashboardComponent* comp);
+  void refreshValueFragment(DashboardComponent* comp);
+  void sampleBindings();
+  bool sampleBinding(DashboardComponent* comp);
+  bool attachBinding(const char* id, BindingType type, int precision,
+                     portMUX_TYPE* lock, DashboardComponent** out);
+#if DASHBOARD_ENABLE_LOGGING
+  char* logMessage(int index) { return _logText + index * _logLength; }
+  bool publishLog(uint8_t level);
   void cleanupOldLogs();
+#endif
   void handleNotFound(AsyncWebServerRequest* request);
+  DashboardComponent* createComponent(const char* id, const char* label,
+                                      ComponentType type, void* callback);
+  bool deleteComponent(DashboardComponent* comp);
+  void releaseComponent(DashboardComponent* comp);
   DashboardComponent* findComponent(const char* id);
+  WebClient* findClient(uint32_t clientId);
+  bool growComponents();
+  int indexOf(DashboardComponent* comp);
+  static uint32_t hashId(const char* id);
+  void indexComponent(int index);
+  void unindexComponent(int index);
+  bool rebuildIdIndex(int size);
+  void markPending(DashboardComponent* comp);
+  bool storeValue(DashboardComponent* comp, const char* value);
+  bool storeValue(DashboardComponent* comp, int value);
+  bool storeValue(DashboardComponent* comp, float value, int precision);
+  bool storeValue(DashboardComponent* comp, bool value);
+  bool setValue(DashboardComponent* comp, const char* value);
+  bool setValue(DashboardComponent* comp, int value);
+  bool setValue(DashboardComponent* comp, float value, int precision);
+  bool setValue(DashboardComponent* comp, bool value);
+
+  DashboardComponent* component(int index) {
+    if (index < _componentCapacity) {
+      return &_components[index];
+    }
+    index -= _componentCapacity;
+    return &_segments[index / DASHBOARD_COMPONENT_SEGMENT_SIZE]
+                     [index % DASHBOARD_COMPONENT_SEGMENT_SIZE];
+  }
+
+  template <ComponentType T>
+  DashboardComponent* resolve(ComponentHandle<T> handle) {
+    if (handle.index < 0 || handle.index >= _componentCount) {
+      return NULL;
+    }
+    DashboardComponent* comp = component(handle.index);
+    return comp->active && comp->generation == handle.generation ? comp : NULL;
+  }
+
+  template <ComponentType T>
+  ComponentHandle<T> handleFor(DashboardComponent* comp) {
+    if (!comp) {
+      return ComponentHandle<T>();
+    }
+    return ComponentHandle<T>(indexOf(comp), comp->generation);
+  }
+};
+
+// Storage of a BasicWebDashboard, sized at compile time
+template <int Components, int Clients, int Logs, int LogLength>
+struct DashboardStorage {
+  // Handles address components with a 16-bit index
+  static_assert(Components > 0 && Components <= 32767,
+                "dashboard needs 1 to 32767 components");
+  static_assert(Clients > 0 && Clients <= 255,
+                "dashboard needs 1 to 255 clients");
+  static_assert(Logs > 0, "dashboard needs at least one log entry");
+  static_assert(LogLength >= 16 && LogLength <= 4096,
+                "log length must be between 16 and 4096 bytes");
+
+  WebDashboardBase::DashboardComponent components[Components];
+  WebDashboardBase::WebClient clients[Clients];
+#if DASHBOARD_ENABLE_LOGGING
+  WebDashboardBase::LogEntry logEntries[Logs];
+  char logText[Logs * LogLength];
+
+  WebDashboardBase::LogEntry* logEntryData() { return logEntries; }
+  char* logTextData() { return logText; }
+#else
+  WebDashboardBase::LogEntry* logEntryData() { return NULL; }
+  char* logTextData() { return NULL; }
+#endif
+};
+
+/**
+ * Dashboard with capacities fixed at compile time
+ *
+ * Arrays are sized exactly from the template arguments, so a node with three
+ * components doesn't pay for fifty:
+ *
+ *   BasicWebDashboard<3, 2, 20, 128> dashboard;
+ *
+ * @tparam Components Maximum number of components
+ * @tparam Clients Maximum number of WebSocket clients tracked
+ * @tparam Logs Number of log entries kept for new clients
+ * @tparam LogLength Size of each log message, including terminator
+ */
+template <int Components, int Clients = MAX_DASHBOARD_CLIENTS,
+          int Logs = MAX_LOG_ENTRIES, int LogLength = MAX_LOG_LENGTH>
+class BasicWebDashboard
+    : private DashboardStorage<Components, Clients, Logs, LogLength>,
+      public WebDashboardBase {
+ public:
+  // The storage base is constructed first, so its arrays can be handed over
+  BasicWebDashboard()
+      : WebDashboardBase(this->components, Components, this->clients, Clients,
+                         this->logEntryData(), this->logTextData(), Logs,
+                         LogLength) {}
+};
+
+// Dashboard with the default MAX_* capacities
+typedef BasicWebDashboard<MAX_DASHBOARD_COMPONENTS, MAX_DASHBOARD_CLIENTS,
+                          MAX_LOG_ENTRIES, MAX_LOG_LENGTH>
+    WebDashboard;
+
+/**
+ * Scoped batch: opens a batch on construction and commits it when it goes
+ * out of scope, so every change inside the block reaches clients as a single
+ * frame.
+ *
+ *   {
+ *     DashboardBatch batch(dashboard);
+ *     dashboard.setMachineState("RUNNING");
+ *     dashboard.updateValue("speed", 100);
+ *   }  // one batch_update frame is sent here
+ */
+class DashboardBatch {
+ public:
+  explicit DashboardBatch(WebDashboardBase& dashboard)
+      : _dashboard(dashboard) {
+    _dashboard.beginBatch();
+  }
+  ~DashboardBatch() { _dashboard.commit(); }
+
+ private:
+  DashboardBatch(const DashboardBatch&);
+  DashboardBatch& operator=(const DashboardBatch&);
+
+  WebDashboardBase& _dashboard;
 };
 
 #endif  // WebDashboard_h
\ No newline at end of file
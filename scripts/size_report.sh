@@ -0,0 +1,45 @@
+#!/usr/bin/env bash
+#
+# Build every example under each feature policy and print its flash and RAM
+# use, so the effect of the DASHBOARD_ENABLE_* flags can be compared.
+#
+# Requires PlatformIO (pio) on the PATH. Run from anywhere:
+#   scripts/size_report.sh [example...]
+
+set -e
+cd "$(dirname "$0")/.."
+
+POLICIES=(
+  "full|"
+  "no-logging|-DDASHBOARD_ENABLE_LOGGING=0"
+  "no-pin-monitors|-DDASHBOARD_ENABLE_PIN_MONITORS=0"
+  "no-controls|-DDASHBOARD_ENABLE_CONTROLS=0"
+  "no-html|-DDASHBOARD_ENABLE_HTML=0"
+  "no-events|-DDASHBOARD_ENABLE_EVENTS=0"
+  "no-rest|-DDASHBOARD_ENABLE_REST=0"
+  "no-rpc|-DDASHBOARD_ENABLE_RPC=0"
+  "headless|-DDASHBOARD_ENABLE_LOGGING=0 -DDASHBOARD_ENABLE_PIN_MONITORS=0 -DDASHBOARD_ENABLE_CONTROLS=0 -DDASHBOARD_ENABLE_HTML=0 -DDASHBOARD_ENABLE_EVENTS=0"
+)
+
+if [ $# -gt 0 ]; then
+  EXAMPLES=("$@")
+else
+  EXAMPLES=(examples/*)
+fi
+
+printf "%-22s %-16s %12s %12s\n" "Example" "Policy" "Flash" "RAM"
+for example in "${EXAMPLES[@]}"; do
+  for policy in "${POLICIES[@]}"; do
+    name="${policy%%|*}"
+    flags="${policy#*|}"
+    output=$(pio ci "$example" --lib . --project-conf platformio.ini \
+      --environment esp32dev --project-option "build_flags=$flags" 2>&1) || {
+      printf "%-22s %-16s %25s\n" "$(basename "$example")" "$name" "FAILED"
+      continue
+    }
+    flash=$(echo "$output" | sed -n 's/.*Flash:.*used \([0-9]*\) bytes.*/\1/p')
+    ram=$(echo "$output" | sed -n 's/.*RAM:.*used \([0-9]*\) bytes.*/\1/p')
+    printf "%-22s %-16s %12s %12s\n" "$(basename "$example")" "$name" \
+      "$flash" "$ram"
+  done
+done
@@ -0,0 +1,342 @@
+#include "../include/DashboardEvents.h"
+
+#include <ESPAsyncWebServer.h>
+
+// Reference counts are kept in uint8_t and slots in the low byte of ids
+static_assert(DASHBOARD_EVENT_VIEWERS > 0 && DASHBOARD_EVENT_VIEWERS <= 255,
+              "DASHBOARD_EVENT_VIEWERS must be between 1 and 255");
+static_assert(DASHBOARD_EVENT_RING > 0,
+              "DASHBOARD_EVENT_RING must be at least 1");
+
+// Sent first: how long the browser waits before reconnecting
+static const char EVENT_GREETING[] = "retry: 2000\n\n";
+static const char EVENT_KEEPALIVE[] = ":\n\n";
+
+DashboardEvents::DashboardEvents(DashboardPool& pool) : _pool(pool) {
+  memset(_frames, 0, sizeof(_frames));
+  memset(_viewers, 0, sizeof(_viewers));
+  memset(&_stats, 0, sizeof(_stats));
+  _first = 0;
+  _next = 0;
+  _generation = 0;
+  _lock = portMUX_INITIALIZER_UNLOCKED;
+}
+
+DashboardEvents::~DashboardEvents() {
+  for (uint32_t n = _first; n != _next; n++) {
+    _pool.deallocate(at(n).data);
+  }
+  for (int i = 0; i < DASHBOARD_EVENT_VIEWERS; i++) {
+    _pool.deallocate(_viewers[i].page);
+  }
+}
+
+uint32_t DashboardEvents::open() {
+  portENTER_CRITICAL(&_lock);
+  for (int i = 0; i < DASHBOARD_EVENT_VIEWERS; i++) {
+    Viewer& viewer = _viewers[i];
+    if (viewer.id != 0) {
+      continue;
+    }
+
+    // A new generation each time, so a stale id never matches the slot
+    memset(&viewer, 0, sizeof(viewer));
+    viewer.id = DASHBOARD_EVENT_CLIENT | (uint32_t)++_generation << 8 | i;
+    viewer.next = _next;
+    viewer.lastSent = millis();
+    _stats.viewers++;
+    uint32_t id = viewer.id;
+    portEXIT_CRITICAL(&_lock);
+    return id;
+  }
+  portEXIT_CRITICAL(&_lock);
+  return 0;
+}
+
+uint32_t DashboardEvents::accept() {
+  portENTER_CRITICAL(&_lock);
+  uint32_t id = 0;
+  for (int i = 0; i < DASHBOARD_EVENT_VIEWERS && id == 0; i++) {
+    Viewer& viewer = _viewers[i];
+    if (viewer.id != 0 && !viewer.accepted) {
+      viewer.accepted = true;
+      id = viewer.id;
+    }
+  }
+  portEXIT_CRITICAL(&_lock);
+  return id;
+}
+
+void DashboardEvents::close(uint32_t id) {
+  char* freed[DASHBOARD_EVENT_RING + 1];
+  int freedCount = 0;
+
+  portENTER_CRITICAL(&_lock);
+  Viewer* viewer = find(id);
+  if (viewer) {
+    release(viewer);
+    freed[freedCount++] = viewer->page;
+    viewer->page = NULL;
+    viewer->id = 0;
+    _stats.viewers--;
+    freedCount += trim(freed + freedCount);
+  }
+  portEXIT_CRITICAL(&_lock);
+
+  for (int i = 0; i < freedCount; i++) {
+    _pool.deallocate(freed[i]);
+  }
+}
+
+bool DashboardEvents::connected(uint32_t id) {
+  portENTER_CRITICAL(&_lock);
+  Viewer* viewer = find(id);
+  bool connected = viewer && !viewer->lost;
+  portEXIT_CRITICAL(&_lock);
+  return connected;
+}
+
+bool DashboardEvents::ready(uint32_t id) {
+  portENTER_CRITICAL(&_lock);
+  Viewer* viewer = find(id);
+  bool ready = viewer && !viewer->lost && !viewer->page;
+  portEXIT_CRITICAL(&_lock);
+  return ready;
+}
+
+bool DashboardEvents::send(uint32_t id, const char* data, size_t length) {
+  // Formatted outside the lock; the caller's frame goes out of scope
+  char* page = format(data, length);
+  if (!page) {
+    return false;
+  }
+
+  portENTER_CRITICAL(&_lock);
+  Viewer* viewer = find(id);
+  bool taken = viewer && !viewer->lost && !viewer->page;
+  if (taken) {
+    viewer->page = page;
+    viewer->pageLength = length + 8;
+    viewer->offset = 0;
+  }
+  portEXIT_CRITICAL(&_lock);
+
+  if (!taken) {
+    _pool.deallocate(page);
+  }
+  return taken;
+}
+
+void DashboardEvents::stream(uint32_t id) {
+  portENTER_CRITICAL(&_lock);
+  Viewer* viewer = find(id);
+  if (viewer && !viewer->lost && !viewer->streaming) {
+    viewer->next = _next;
+    viewer->streaming = true;
+  }
+  portEXIT_CRITICAL(&_lock);
+}
+
+void DashboardEvents::publish(const char* data, size_t length) {
+  // Nobody to keep it for; also the common case of no viewers at all
+  if (count() == 0) {
+    return;
+  }
+
+  char* copy = format(data, length);
+  char* freed[DASHBOARD_EVENT_RING + 1];
+  int freedCount = 0;
+
+  portENTER_CRITICAL(&_lock);
+  if (!copy) {
+    // Viewers would silently miss the frame; let them start over instead
+    for (int i = 0; i < DASHBOARD_EVENT_VIEWERS; i++) {
+      if (release(&_viewers[i])) {
+        _stats.viewersDropped++;
+      }
+    }
+  } else if (_next - _first == DASHBOARD_EVENT_RING) {
+    // The ring is full: viewers still on the oldest frame fall behind
+    for (int i = 0; i < DASHBOARD_EVENT_VIEWERS; i++) {
+      if (_viewers[i].streaming && _viewers[i].next == _first &&
+          release(&_viewers[i])) {
+        _stats.viewersDropped++;
+      }
+    }
+  }
+  freedCount = trim(freed);
+
+  uint8_t refs = 0;
+  for (int i = 0; i < DASHBOARD_EVENT_VIEWERS; i++) {
+    if (_viewers[i].id != 0 && !_viewers[i].lost && _viewers[i].streaming) {
+      refs++;
+    }
+  }
+  if (copy && refs > 0) {
+    Frame& frame = at(_next);
+    frame.data = copy;
+    frame.length = length + 8;
+    frame.refs = refs;
+    _next++;
+    _stats.published++;
+    if (_next - _first > _stats.highWater) {
+      _stats.highWater = _next - _first;
+    }
+  } else {
+    freed[freedCount++] = copy;
+  }
+  portEXIT_CRITICAL(&_lock);
+
+  for (int i = 0; i < freedCount; i++) {
+    _pool.deallocate(freed[i]);
+  }
+}
+
+int DashboardEvents::count() {
+  portENTER_CRITICAL(&_lock);
+  int count = _stats.viewers;
+  portEXIT_CRITICAL(&_lock);
+  return count;
+}
+
+size_t DashboardEvents::fill(uint32_t id, uint8_t* buffer, size_t maxLength) {
+  char* freed[DASHBOARD_EVENT_RING + 1];
+  int freedCount = 0;
+  size_t written = 0;
+
+  portENTER_CRITICAL(&_lock);
+  Viewer* viewer = find(id);
+  if (!viewer || viewer->lost) {
+    // Ending the response makes the browser reconnect and start over
+    if (viewer) {
+      freed[freedCount++] = viewer->page;
+      viewer->page = NULL;
+      viewer->id = 0;
+      _stats.viewers--;
+    }
+    portEXIT_CRITICAL(&_lock);
+    for (int i = 0; i < freedCount; i++) {
+      _pool.deallocate(freed[i]);
+    }
+    return 0;
+  }
+
+  if (!viewer->greeted && maxLength >= sizeof(EVENT_GREETING) - 1) {
+    memcpy(buffer, EVENT_GREETING, sizeof(EVENT_GREETING) - 1);
+    written = sizeof(EVENT_GREETING) - 1;
+    viewer->greeted = true;
+  }
+
+  // Its own pages first, then the ring, for as long as there is room.
+  // Ring frames are copied straight from the shared buffer.
+  while (written < maxLength) {
+    bool page = viewer->page != NULL;
+    if (!page && (!viewer->streaming || viewer->next == _next)) {
+      break;
+    }
+    const char* data = page ? viewer->page : at(viewer->next).data;
+    size_t length = page ? viewer->pageLength : at(viewer->next).length;
+
+    size_t chunk = min(length - viewer->offset, maxLength - written);
+    memcpy(buffer + written, data + viewer->offset, chunk);
+    written += chunk;
+    viewer->offset += chunk;
+    if (viewer->offset < length) {
+      break;
+    }
+
+    viewer->offset = 0;
+    if (page) {
+      freed[freedCount++] = viewer->page;
+      viewer->page = NULL;
+    } else {
+      Frame& frame = at(viewer->next++);
+      if (frame.refs > 1) {
+        _stats.copiesSaved++;
+      }
+      frame.refs--;
+      _stats.delivered++;
+    }
+  }
+  freedCount += trim(freed + freedCount);
+
+  if (written > 0) {
+    viewer->lastSent = millis();
+  } else if (millis() - viewer->lastSent >= DASHBOARD_EVENT_KEEPALIVE &&
+             maxLength >= sizeof(EVENT_KEEPALIVE) - 1) {
+    memcpy(buffer, EVENT_KEEPALIVE, sizeof(EVENT_KEEPALIVE) - 1);
+    written = sizeof(EVENT_KEEPALIVE) - 1;
+    viewer->lastSent = millis();
+  }
+  portEXIT_CRITICAL(&_lock);
+
+  for (int i = 0; i < freedCount; i++) {
+    _pool.deallocate(freed[i]);
+  }
+  return written > 0 ? written : RESPONSE_TRY_AGAIN;
+}
+
+void DashboardEvents::getStats(DashboardEventStats* stats) {
+  portENTER_CRITICAL(&_lock);
+  *stats = _stats;
+  portEXIT_CRITICAL(&_lock);
+}
+
+void DashboardEvents::resetStats() {
+  portENTER_CRITICAL(&_lock);
+  uint16_t viewers = _stats.viewers;
+  memset(&_stats, 0, sizeof(_stats));
+  _stats.viewers = viewers;
+  _stats.highWater = _next - _first;
+  portEXIT_CRITICAL(&_lock);
+}
+
+// Find a viewer by id; called with the lock held
+DashboardEvents::Viewer* DashboardEvents::find(uint32_t id) {
+  if (!(id & DASHBOARD_EVENT_CLIENT)) {
+    return NULL;
+  }
+  Viewer* viewer = &_viewers[(id & 0xFF) % DASHBOARD_EVENT_VIEWERS];
+  return viewer->id == id ? viewer : NULL;
+}
+
+// Copy a frame into a pool buffer as a "data:" event
+char* DashboardEvents::format(const char* data, size_t length) {
+  if (length + 8 > UINT16_MAX) {
+    return NULL;
+  }
+  char* event = (char*)_pool.allocate(length + 8);
+  if (event) {
+    memcpy(event, "data: ", 6);
+    memcpy(event + 6, data, length);
+    memcpy(event + 6 + length, "\n\n", 2);
+  }
+  return event;
+}
+
+// Drop a viewer's references to the frames it hasn't sent and mark it
+// lost; returns false if it had none. Called with the lock held.
+bool DashboardEvents::release(Viewer* viewer) {
+  if (viewer->id == 0 || viewer->lost) {
+    return false;
+  }
+  for (uint32_t n = viewer->next; viewer->streaming && n != _next; n++) {
+    at(n).refs--;
+  }
+  viewer->lost = true;
+  viewer->next = _next;
+  viewer->offset = 0;
+  return true;
+}
+
+// Take the frames every viewer has sent off the front of the ring; their
+// buffers are returned through freed. Called with the lock held.
+int DashboardEvents::trim(char** freed) {
+  int trimmed = 0;
+  while (_first != _next && at(_first).refs == 0) {
+    freed[trimmed++] = at(_first).data;
+    at(_first).data = NULL;
+    _first++;
+  }
+  return trimmed;
+}
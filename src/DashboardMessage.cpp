@@ -0,0 +1,438 @@
+#include "../include/DashboardMessage.h"
+
+// Encode a code point as UTF-8 at out; returns the bytes written
+static int encodeUtf8(uint32_t codePoint, char* out) {
+  if (codePoint < 0x80) {
+    out[0] = codePoint;
+    return 1;
+  }
+  if (codePoint < 0x800) {
+    out[0] = 0xC0 | (codePoint >> 6);
+    out[1] = 0x80 | (codePoint & 0x3F);
+    return 2;
+  }
+  if (codePoint < 0x10000) {
+    out[0] = 0xE0 | (codePoint >> 12);
+    out[1] = 0x80 | ((codePoint >> 6) & 0x3F);
+    out[2] = 0x80 | (codePoint & 0x3F);
+    return 3;
+  }
+  out[0] = 0xF0 | (codePoint >> 18);
+  out[1] = 0x80 | ((codePoint >> 12) & 0x3F);
+  out[2] = 0x80 | ((codePoint >> 6) & 0x3F);
+  out[3] = 0x80 | (codePoint & 0x3F);
+  return 4;
+}
+
+// Read 4 hex digits; returns -1 if they aren't
+static int32_t readHex4(const char* p, const char* end) {
+  if (end - p < 4) {
+    return -1;
+  }
+  int32_t value = 0;
+  for (int i = 0; i < 4; i++) {
+    char c = p[i];
+    int digit = c >= '0' && c <= '9'   ? c - '0'
+                : c >= 'a' && c <= 'f' ? c - 'a' + 10
+                : c >= 'A' && c <= 'F' ? c - 'A' + 10
+                                       : -1;
+    if (digit < 0) {
+      return -1;
+    }
+    value = value * 16 + digit;
+  }
+  return value;
+}
+
+bool DashboardMessage::parse(char* frame, size_t length) {
+  reset();
+  _cursor = frame;
+  _end = frame + length;
+  bool parsed = parseObject();
+  finish();
+  return parsed;
+}
+
+bool DashboardMessage::parseNext(char** cursor, char* end) {
+  reset();
+  _cursor = *cursor;
+  _end = end;
+
+  // The bracket opens the batch, and a comma comes before every other call
+  skipSpace();
+  char c = _cursor < _end ? *_cursor : '\0';
+  if (c == ']') {
+    return false;
+  }
+  if (c != '[' && c != ',') {
+    *cursor = NULL;
+    return false;
+  }
+  _cursor++;
+  skipSpace();
+  if (c == '[' && _cursor < _end && *_cursor == ']') {
+    *cursor = _cursor;
+    return false;
+  }
+
+  // Anything but an object is no call, but the rest of the batch still is
+  bool parsed = _cursor < _end &&
+                (*_cursor == '{' ? parseObject() : readValue(""));
+  if (!parsed) {
+    *cursor = NULL;
+    return false;
+  }
+  finish();
+  *cursor = _cursor;
+  return true;
+}
+
+void DashboardMessage::reset() {
+  type = DashboardMessageType::UNKNOWN;
+  id = NULL;
+  text = NULL;
+  number = 0;
+  flag = false;
+  schemaHash = NULL;
+  groups = -1;
+  rpc = false;
+  hasRequestId = false;
+  requestId = NULL;
+  requestNumber = 0;
+  requestNull = false;
+  _inParams = false;
+  _callId = NULL;
+  _paramId = NULL;
+}
+
+// Parse the object under the cursor and leave the cursor past its end
+bool DashboardMessage::parseObject() {
+  skipSpace();
+  if (_cursor == _end || *_cursor != '{') {
+    return false;
+  }
+  _cursor++;
+  skipSpace();
+  if (_cursor < _end && *_cursor == '}') {
+    _cursor++;
+    return true;
+  }
+
+  while (true) {
+    skipSpace();
+    if (_cursor == _end || *_cursor != '"') {
+      return false;
+    }
+    uint32_t hash;
+    const char* key = readString(&hash);
+    skipSpace();
+    if (!key || _cursor == _end || *_cursor != ':') {
+      return false;
+    }
+    _cursor++;
+    skipSpace();
+    if (!readValue(key)) {
+      return false;
+    }
+
+    skipSpace();
+    if (_cursor == _end) {
+      return false;
+    }
+    char c = *_cursor++;
+    if (c == '}') {
+      return true;
+    }
+    if (c != ',') {
+      return false;
+    }
+  }
+}
+
+// A call names the component in its params, and its own id is the one to
+// answer with
+void DashboardMessage::finish() {
+  if (rpc) {
+    requestId = _callId;
+    hasRequestId = hasRequestId || _callId;
+    id = _paramId;
+  } else {
+    hasRequestId = false;
+    requestNumber = 0;
+    requestNull = false;
+    id = _callId;
+  }
+}
+
+void DashboardMessage::skipSpace() {
+  while (_cursor < _end && (*_cursor == ' ' || *_cursor == '\t' ||
+                            *_cursor == '\n' || *_cursor == '\r')) {
+    _cursor++;
+  }
+}
+
+// Read the string starting at the opening quote under the cursor. It is
+// unescaped in place, which never makes it longer, and terminated where the
+// closing quote was. The FNV-1a hash of the result is computed on the way.
+char* DashboardMessage::readString(uint32_t* hash) {
+  char* start = ++_cursor;
+  char* out = start;
+  *hash = 2166136261u;
+
+  while (_cursor < _end) {
+    char c = *_cursor++;
+    if (c == '"') {
+      *out = '\0';
+      return start;
+    }
+
+    char decoded[4];
+    int count = 1;
+    decoded[0] = c;
+    if (c == '\\') {
+      if (_cursor == _end) {
+        return NULL;
+      }
+      char escape = *_cursor++;
+      switch (escape) {
+        case '"':
+        case '\\':
+        case '/':
+          decoded[0] = escape;
+          break;
+        case 'b':
+          decoded[0] = '\b';
+          break;
+        case 'f':
+          decoded[0] = '\f';
+          break;
+        case 'n':
+          decoded[0] = '\n';
+          break;
+        case 'r':
+          decoded[0] = '\r';
+          break;
+        case 't':
+          decoded[0] = '\t';
+          break;
+        case 'u': {
+          int32_t codePoint = readHex4(_cursor, _end);
+          if (codePoint < 0) {
+            return NULL;
+          }
+          _cursor += 4;
+
+          // A surrogate pair spells one code point beyond the BMP
+          if (codePoint >= 0xD800 && codePoint < 0xDC00 &&
+              _end - _cursor >= 6 && _cursor[0] == '\\' &&
+              _cursor[1] == 'u') {
+            int32_t low = readHex4(_cursor + 2, _end);
+            if (low >= 0xDC00 && low < 0xE000) {
+              codePoint =
+                  0x10000 + ((codePoint - 0xD800) << 10) + (low - 0xDC00);
+              _cursor += 6;
+            }
+          }
+          count = encodeUtf8(codePoint, decoded);
+          break;
+        }
+        default:
+          return NULL;
+      }
+    }
+
+    for (int i = 0; i < count; i++) {
+      *out++ = decoded[i];
+      *hash = (*hash ^ (uint8_t)decoded[i]) * 16777619u;
+    }
+  }
+  return NULL;
+}
+
+// Read the value under the cursor and store it if the key is one we use
+bool DashboardMessage::readValue(const char* key) {
+  if (_cursor == _end) {
+    return false;
+  }
+  char c = *_cursor;
+  bool isValue = strcmp(key, "value") == 0;
+
+  if (c == '"') {
+    uint32_t hash;
+    char* value = readString(&hash);
+    if (!value) {
+      return false;
+    }
+    if (isValue) {
+      text = value;
+      number = 0;
+      flag = false;
+    } else if (strcmp(key, "type") == 0 || strcmp(key, "method") == 0) {
+      setType(value, hash);
+    } else if (strcmp(key, "id") == 0) {
+      if (_inParams) {
+        _paramId = value;
+      } else {
+        _callId = value;
+      }
+    } else if (strcmp(key, "schemaHash") == 0) {
+      schemaHash = value;
+    } else if (strcmp(key, "jsonrpc") == 0 && !_inParams) {
+      rpc = true;
+    }
+    return true;
+  }
+
+  if (c == 't' || c == 'f' || c == 'n') {
+    const char* literal = c == 't' ? "true" : c == 'f' ? "false" : "null";
+    size_t length = strlen(literal);
+    if ((size_t)(_end - _cursor) < length ||
+        memcmp(_cursor, literal, length) != 0) {
+      return false;
+    }
+    _cursor += length;
+    if (isValue) {
+      text = NULL;
+      flag = c == 't';
+      number = flag;
+    } else if (c == 'n' && strcmp(key, "id") == 0 && !_inParams) {
+      // A call with a null id is still answered, unlike a notification
+      requestNull = true;
+      hasRequestId = true;
+    }
+    return true;
+  }
+
+  if (c == '-' || (c >= '0' && c <= '9')) {
+    bool negative = c == '-';
+    if (negative) {
+      _cursor++;
+    }
+    if (_cursor == _end || *_cursor < '0' || *_cursor > '9') {
+      return false;
+    }
+
+    // Fractions are truncated, as when JSON numbers are read into an int
+    int32_t value = 0;
+    bool fraction = false;
+    while (_cursor < _end && *_cursor >= '0' && *_cursor <= '9') {
+      if (value <= (INT32_MAX - 9) / 10) {
+        value = value * 10 + (*_cursor - '0');
+      }
+      _cursor++;
+    }
+    if (_cursor < _end && *_cursor == '.') {
+      _cursor++;
+      while (_cursor < _end && *_cursor >= '0' && *_cursor <= '9') {
+        fraction |= *_cursor != '0';
+        _cursor++;
+      }
+    }
+    if (_cursor < _end && (*_cursor == 'e' || *_cursor == 'E')) {
+      // The page never sends exponents; accept them but keep the mantissa
+      _cursor++;
+      if (_cursor < _end && (*_cursor == '+' || *_cursor == '-')) {
+        _cursor++;
+      }
+      while (_cursor < _end && *_cursor >= '0' && *_cursor <= '9') {
+        _cursor++;
+      }
+    }
+    if (negative) {
+      value = -value;
+    }
+
+    if (isValue) {
+      text = NULL;
+      number = value;
+      flag = value != 0 || fraction;
+    } else if (strcmp(key, "groups") == 0) {
+      groups = value;
+    } else if (strcmp(key, "id") == 0 && !_inParams) {
+      requestNumber = value;
+      hasRequestId = true;
+    }
+    return true;
+  }
+
+  // A call's params hold the keys a plain message has at the top
+  if (c == '{' && !_inParams && strcmp(key, "params") == 0) {
+    _inParams = true;
+    bool parsed = parseObject();
+    _inParams = false;
+    return parsed;
+  }
+  if (c == '{' || c == '[') {
+    return skipValue();
+  }
+  return false;
+}
+
+// Skip a nested object or array; nothing the page sends has one we need
+bool DashboardMessage::skipValue() {
+  int depth = 0;
+  while (_cursor < _end) {
+    char c = *_cursor;
+    if (c == '"') {
+      uint32_t hash;
+      if (!readString(&hash)) {
+        return false;
+      }
+      continue;
+    }
+    _cursor++;
+    if (c == '{' || c == '[') {
+      depth++;
+    } else if (c == '}' || c == ']') {
+      if (--depth == 0) {
+        return true;
+      }
+    }
+  }
+  return false;
+}
+
+void DashboardMessage::setType(const char* value, uint32_t hash) {
+  DashboardMessageType found;
+  const char* name;
+  switch (hash) {
+    case dashboardMessageHash("request_full_update"):
+      found = DashboardMessageType::REQUEST_FULL_UPDATE;
+      name = "request_full_update";
+      break;
+    case dashboardMessageHash("subscribe"):
+      found = DashboardMessageType::SUBSCRIBE;
+      name = "subscribe";
+      break;
+    case dashboardMessageHash("button_press"):
+      found = DashboardMessageType::BUTTON_PRESS;
+      name = "button_press";
+      break;
+    case dashboardMessageHash("toggle_change"):
+      found = DashboardMessageType::TOGGLE_CHANGE;
+      name = "toggle_change";
+      break;
+    case dashboardMessageHash("slider_change"):
+      found = DashboardMessageType::SLIDER_CHANGE;
+      name = "slider_change";
+      break;
+    case dashboardMessageHash("text_input_change"):
+      found = DashboardMessageType::TEXT_INPUT_CHANGE;
+      name = "text_input_change";
+      break;
+    case dashboardMessageHash("select_change"):
+      found = DashboardMessageType::SELECT_CHANGE;
+      name = "select_change";
+      break;
+    case dashboardMessageHash("get_value"):
+      found = DashboardMessageType::GET_VALUE;
+      name = "get_value";
+      break;
+    default:
+      type = DashboardMessageType::UNKNOWN;
+      return;
+  }
+
+  // Another string can share the hash of a known type
+  type = strcmp(value, name) == 0 ? found : DashboardMessageType::UNKNOWN;
+}
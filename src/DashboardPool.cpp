@@ -0,0 +1,437 @@
+#include "../include/DashboardPool.h"
+
+#include <math.h>
+
+#if __has_include(<esp_memory_utils.h>)
+#include <esp_memory_utils.h>
+#else
+#include <soc/soc_memory_layout.h>
+#endif
+
+// Free slots are tracked as bits, so each class holds at most 32 buffers
+static_assert(POOL_SMALL_COUNT <= 32 && POOL_MEDIUM_COUNT <= 32 &&
+                  POOL_LARGE_COUNT <= 32,
+              "pool size classes hold at most 32 buffers");
+
+static uint32_t fullMask(uint8_t count) {
+  return count >= 32 ? 0xFFFFFFFFu : ((1u << count) - 1);
+}
+
+DashboardPool::DashboardPool() {
+  _slab = NULL;
+  memset(&_stats, 0, sizeof(_stats));
+  _lock = portMUX_INITIALIZER_UNLOCKED;
+
+  _classes[0].size = POOL_SMALL_SIZE;
+  _classes[0].count = POOL_SMALL_COUNT;
+  _classes[1].size = POOL_MEDIUM_SIZE;
+  _classes[1].count = POOL_MEDIUM_COUNT;
+  _classes[2].size = POOL_LARGE_SIZE;
+  _classes[2].count = POOL_LARGE_COUNT;
+  for (int i = 0; i < POOL_CLASS_COUNT; i++) {
+    _classes[i].freeMask = 0;
+    _classes[i].base = NULL;
+  }
+}
+
+DashboardPool::~DashboardPool() { free(_slab); }
+
+bool DashboardPool::begin() {
+  if (_slab) {
+    return true;
+  }
+
+  size_t total = 0;
+  for (int i = 0; i < POOL_CLASS_COUNT; i++) {
+    total += _classes[i].size * _classes[i].count;
+  }
+
+  // One allocation for every class, made before the heap gets fragmented
+  uint8_t* slab = (uint8_t*)malloc(total);
+  if (!slab) {
+    return false;
+  }
+
+  portENTER_CRITICAL(&_lock);
+  if (_slab) {
+    portEXIT_CRITICAL(&_lock);
+    free(slab);
+    return true;
+  }
+  _slab = slab;
+  uint8_t* base = slab;
+  for (int i = 0; i < POOL_CLASS_COUNT; i++) {
+    _classes[i].base = base;
+    _classes[i].freeMask = fullMask(_classes[i].count);
+    base += _classes[i].size * _classes[i].count;
+  }
+  portEXIT_CRITICAL(&_lock);
+  return true;
+}
+
+void* DashboardPool::allocate(size_t size) {
+  if (!_slab) {
+    begin();
+  }
+
+  void* ptr = NULL;
+  portENTER_CRITICAL(&_lock);
+  // Take a slot from the smallest class that fits and still has one free
+  for (int i = 0; i < POOL_CLASS_COUNT && !ptr; i++) {
+    SizeClass& sizeClass = _classes[i];
+    if (size > sizeClass.size || sizeClass.freeMask == 0) {
+      continue;
+    }
+    int slot = __builtin_ctz(sizeClass.freeMask);
+    sizeClass.freeMask &= ~(1u << slot);
+    ptr = sizeClass.base + slot * sizeClass.size;
+    _stats.allocations++;
+    _stats.inUse++;
+    if (_stats.inUse > _stats.highWater) {
+      _stats.highWater = _stats.inUse;
+    }
+  }
+  if (!ptr) {
+    _stats.fallbacks++;
+  }
+  portEXIT_CRITICAL(&_lock);
+
+  return ptr ? ptr : malloc(size);
+}
+
+void DashboardPool::deallocate(void* ptr) {
+  if (!ptr) {
+    return;
+  }
+
+  SizeClass* sizeClass = classOf(ptr);
+  if (!sizeClass) {
+    free(ptr);
+    return;
+  }
+
+  int slot = ((uint8_t*)ptr - sizeClass->base) / sizeClass->size;
+  portENTER_CRITICAL(&_lock);
+  sizeClass->freeMask |= 1u << slot;
+  _stats.inUse--;
+  portEXIT_CRITICAL(&_lock);
+}
+
+void* DashboardPool::reallocate(void* ptr, size_t newSize) {
+  if (!ptr) {
+    return allocate(newSize);
+  }
+
+  SizeClass* sizeClass = classOf(ptr);
+  if (!sizeClass) {
+    return realloc(ptr, newSize);
+  }
+  if (newSize <= sizeClass->size) {
+    return ptr;
+  }
+
+  // Move up to a bigger class (or the heap) and release the old slot
+  void* moved = allocate(newSize);
+  if (moved) {
+    memcpy(moved, ptr, sizeClass->size);
+    deallocate(ptr);
+  }
+  return moved;
+}
+
+size_t DashboardPool::capacityOf(void* ptr) {
+  SizeClass* sizeClass = classOf(ptr);
+  return sizeClass ? sizeClass->size : 0;
+}
+
+DashboardPoolStats DashboardPool::getStats() {
+  portENTER_CRITICAL(&_lock);
+  DashboardPoolStats stats = _stats;
+  portEXIT_CRITICAL(&_lock);
+  return stats;
+}
+
+void DashboardPool::resetStats() {
+  portENTER_CRITICAL(&_lock);
+  _stats.allocations = 0;
+  _stats.fallbacks = 0;
+  _stats.highWater = _stats.inUse;
+  portEXIT_CRITICAL(&_lock);
+}
+
+DashboardPool::SizeClass* DashboardPool::classOf(void* ptr) {
+  uint8_t* p = (uint8_t*)ptr;
+  for (int i = 0; i < POOL_CLASS_COUNT; i++) {
+    SizeClass& sizeClass = _classes[i];
+    if (sizeClass.base && p >= sizeClass.base &&
+        p < sizeClass.base + sizeClass.size * sizeClass.count) {
+      return &sizeClass;
+    }
+  }
+  return NULL;
+}
+
+DashboardFrame::DashboardFrame(DashboardPool& pool, size_t capacity)
+    : _pool(pool),
+      _data(NULL),
+      _length(0),
+      _capacity(0),
+      _overflowed(false),
+      _fixed(false) {
+  reserve(capacity);
+}
+
+DashboardFrame::DashboardFrame(DashboardPool& pool, size_t capacity,
+                               char* storage)
+    : _pool(pool),
+      _data(NULL),
+      _length(0),
+      _capacity(0),
+      _overflowed(false),
+      _fixed(storage != NULL) {
+  if (_fixed) {
+    _data = storage;
+    _capacity = capacity + 1;
+    _data[0] = '\0';
+  } else {
+    reserve(capacity);
+  }
+}
+
+DashboardFrame::~DashboardFrame() {
+  if (!_fixed) {
+    _pool.deallocate(_data);
+  }
+}
+
+bool DashboardFrame::reserve(size_t length) {
+  if (length + 1 <= _capacity) {
+    return true;
+  }
+  if (_fixed) {
+    _overflowed = true;
+    return false;
+  }
+
+  // Grow geometrically so heap fallbacks don't reallocate on every append;
+  // pool buffers use their whole size class anyway
+  size_t request = _capacity + _capacity / 2;
+  if (request < length + 1) {
+    request = length + 1;
+  }
+  char* data = (char*)_pool.reallocate(_data, request);
+  if (!data) {
+    _overflowed = true;
+    return false;
+  }
+  size_t capacity = _pool.capacityOf(data);
+  _data = data;
+  _capacity = capacity > request ? capacity : request;
+  _data[_length] = '\0';
+  return true;
+}
+
+void DashboardFrame::append(const char* data, size_t length) {
+  if (length == 0) {
+    return;
+  }
+  if (!reserve(_length + length)) {
+    return;
+  }
+  memcpy(_data + _length, data, length);
+  _length += length;
+  _data[_length] = '\0';
+}
+
+void DashboardFrame::append(const char* str) { append(str, strlen(str)); }
+
+void DashboardFrame::append(char c) { append(&c, 1); }
+
+void DashboardFrame::append(int value) {
+  char buffer[12];
+  append(buffer, snprintf(buffer, sizeof(buffer), "%d", value));
+}
+
+void DashboardFrame::append(uint32_t value) {
+  char buffer[12];
+  append(buffer, snprintf(buffer, sizeof(buffer), "%lu",
+                          (unsigned long)value));
+}
+
+void DashboardFrame::appendFloat(float value, uint8_t precision) {
+  if (isnan(value) || isinf(value)) {
+    append("null", 4);
+    return;
+  }
+  if (precision > 6) {
+    precision = 6;
+  }
+  char buffer[DASHBOARD_FLOAT_LENGTH + 1];
+  size_t length =
+      snprintf(buffer, sizeof(buffer), "%.*f", precision, (double)value);
+  append(buffer, length < sizeof(buffer) ? length : sizeof(buffer) - 1);
+}
+
+void DashboardFrame::appendJsonString(const char* value) {
+  append('"');
+  const char* run = value;
+  const char* p = value;
+  for (; *p; p++) {
+    unsigned char c = *p;
+    if (c >= 0x20 && c != '"' && c != '\\') {
+      continue;
+    }
+
+    // Flush the plain run before the escaped character
+    append(run, p - run);
+    run = p + 1;
+
+    switch (c) {
+      case '"':
+        append("\\\"", 2);
+        break;
+      case '\\':
+        append("\\\\", 2);
+        break;
+      case '\n':
+        append("\\n", 2);
+        break;
+      case '\r':
+        append("\\r", 2);
+        break;
+      case '\t':
+        append("\\t", 2);
+        break;
+      default: {
+        char escaped[8];
+        append(escaped, snprintf(escaped, sizeof(escaped), "\\u%04x", c));
+        break;
+      }
+    }
+  }
+  append(run, p - run);
+  append('"');
+}
+
+size_t DashboardFrame::jsonStringLength(const char* value) {
+  size_t length = 2;
+  for (const char* p = value; *p; p++) {
+    unsigned char c = *p;
+    if (c >= 0x20 && c != '"' && c != '\\') {
+      length++;
+    } else if (c == '"' || c == '\\' || c == '\n' || c == '\r' ||
+               c == '\t') {
+      length += 2;
+    } else {
+      length += 6;
+    }
+  }
+  return length;
+}
+
+DashboardStringArena::DashboardStringArena() {
+  _data = NULL;
+  _head = sizeof(char*);
+  _tail = 0;
+  _blockSize = 0;
+  _capacity = 0;
+  _retired = 0;
+}
+
+DashboardStringArena::~DashboardStringArena() {
+  while (_data) {
+    char* previous = *(char**)_data;
+    free(_data);
+    _data = previous;
+  }
+}
+
+// Chain on a new block and continue in it
+bool DashboardStringArena::grow() {
+  char* block = (char*)malloc(DASHBOARD_STRING_ARENA_SIZE);
+  if (!block) {
+    return false;
+  }
+  *(char**)block = _data;
+
+  _retired = used();
+  _data = block;
+  _head = sizeof(char*);
+  _tail = DASHBOARD_STRING_ARENA_SIZE;
+  _blockSize = DASHBOARD_STRING_ARENA_SIZE;
+  _capacity += DASHBOARD_STRING_ARENA_SIZE;
+  return true;
+}
+
+const char* DashboardStringArena::intern(const char* str, size_t maxLength) {
+  if (!str) {
+    str = "";
+  }
+  size_t length = strnlen(str, maxLength - 1);
+
+  // Literals are already in flash; only truncated ones need a copy
+  if (esp_ptr_in_drom(str) && str[length] == '\0') {
+    return str;
+  }
+
+  const char* existing = find(str, length);
+  if (existing) {
+    return existing;
+  }
+
+  // Strings never span blocks
+  if (_head + length + 1 > _tail) {
+    if (sizeof(char*) + length + 1 > DASHBOARD_STRING_ARENA_SIZE || !grow()) {
+      return NULL;
+    }
+  }
+  char* copy = _data + _head;
+  memcpy(copy, str, length);
+  copy[length] = '\0';
+  _head += length + 1;
+  return copy;
+}
+
+const char** DashboardStringArena::internList(const char** strs, int count,
+                                              size_t maxLength) {
+  // Lists are taken from the end of the block, pointer aligned
+  size_t size = count * sizeof(const char*);
+  if (sizeof(char*) + size > DASHBOARD_STRING_ARENA_SIZE) {
+    return NULL;
+  }
+  if (size > _tail ||
+      ((_tail - size) & ~(sizeof(const char*) - 1)) < _head) {
+    if (!grow()) {
+      return NULL;
+    }
+  }
+  _tail = (_tail - size) & ~(sizeof(const char*) - 1);
+
+  // The strings may go to a later block; the list itself stays put
+  const char** list = (const char**)(_data + _tail);
+  for (int i = 0; i < count; i++) {
+    list[i] = intern(strs[i], maxLength);
+    if (!list[i]) {
+      return NULL;
+    }
+  }
+  return list;
+}
+
+// Only the current block is searched, which bounds the cost of a lookup
+// however large the arena grows
+const char* DashboardStringArena::find(const char* str, size_t length) {
+  if (!_data) {
+    return NULL;
+  }
+  const char* p = _data + sizeof(char*);
+  const char* end = _data + _head;
+  while (p < end) {
+    size_t stored = strlen(p);
+    if (stored == length && memcmp(p, str, length) == 0) {
+      return p;
+    }
+    p += stored + 1;
+  }
+  return NULL;
+}
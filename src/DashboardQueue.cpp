@@ -0,0 +1,298 @@
+#include "../include/DashboardQueue.h"
+
+// Ring positions are kept in uint8_t
+static_assert(DASHBOARD_QUEUE_LENGTH > 0 && DASHBOARD_QUEUE_LENGTH <= 255,
+              "DASHBOARD_QUEUE_LENGTH must be between 1 and 255");
+
+DashboardQueue::DashboardQueue() {
+  memset(_rings, 0, sizeof(_rings));
+  _buffers = NULL;
+  _bufferCount = 0;
+  _draining = false;
+  _lock = portMUX_INITIALIZER_UNLOCKED;
+}
+
+DashboardQueue::~DashboardQueue() {
+  for (int c = 0; c < PRIORITY_COUNT; c++) {
+    Ring& ring = _rings[c];
+    for (int i = 0; i < ring.count; i++) {
+      at(ring, i).message->_holders--;
+    }
+  }
+
+  // Buffers a socket is still sending are left to it; dashboards are only
+  // destroyed before they have any clients
+  collect();
+}
+
+DashboardSocketBuffer* DashboardQueue::makeBuffer(size_t length) {
+  DashboardSocketBuffer* buffer = new DashboardSocketBuffer(length);
+  if (!buffer) {
+    return NULL;
+  }
+  if (!buffer->get()) {
+    delete buffer;
+    return NULL;
+  }
+
+  portENTER_CRITICAL(&_lock);
+  buffer->_next = _buffers;
+  _buffers = buffer;
+  _bufferCount++;
+  portEXIT_CRITICAL(&_lock);
+  return buffer;
+}
+
+void DashboardQueue::holdBuffer(DashboardSocketBuffer* buffer) {
+  portENTER_CRITICAL(&_lock);
+  buffer->_holders++;
+  portEXIT_CRITICAL(&_lock);
+}
+
+void DashboardQueue::releaseBuffer(DashboardSocketBuffer* buffer) {
+  portENTER_CRITICAL(&_lock);
+  buffer->_holders--;
+  portEXIT_CRITICAL(&_lock);
+}
+
+void DashboardQueue::collect() {
+  // Unlinked under the lock, deleted outside it
+  DashboardSocketBuffer* freed = NULL;
+  portENTER_CRITICAL(&_lock);
+  DashboardSocketBuffer** link = &_buffers;
+  while (*link) {
+    DashboardSocketBuffer* buffer = *link;
+    if (buffer->_holders == 0 && buffer->canDelete()) {
+      *link = buffer->_next;
+      buffer->_next = freed;
+      freed = buffer;
+      _bufferCount--;
+    } else {
+      link = &buffer->_next;
+    }
+  }
+  portEXIT_CRITICAL(&_lock);
+
+  while (freed) {
+    DashboardSocketBuffer* next = freed->_next;
+    delete freed;
+    freed = next;
+  }
+}
+
+int DashboardQueue::buffers() {
+  portENTER_CRITICAL(&_lock);
+  int count = _bufferCount;
+  portEXIT_CRITICAL(&_lock);
+  return count;
+}
+
+bool DashboardQueue::push(uint8_t priority, uint32_t clientId,
+                          DashboardSocketBuffer* message, const void* key,
+                          bool* overflow) {
+  *overflow = false;
+  size_t length = message->length();
+
+  portENTER_CRITICAL(&_lock);
+
+  // Only the newest value of a component matters. Telemetry takes the place
+  // of the waiting frame; a higher class removes it, since the old value
+  // would otherwise arrive after the new one.
+  Ring& telemetry = _rings[PRIORITY_TELEMETRY];
+  for (int i = 0; key && priority <= PRIORITY_TELEMETRY && i < telemetry.count;
+       i++) {
+    DashboardQueuedFrame& waiting = at(telemetry, i);
+    if (waiting.key != key || waiting.clientId != clientId) {
+      continue;
+    }
+    waiting.message->_holders--;
+    telemetry.stats.coalesced++;
+    if (priority == PRIORITY_TELEMETRY) {
+      // Held until sent, however long the caller's frame lives
+      message->_holders++;
+      waiting.message = message;
+      waiting.length = length;
+      portEXIT_CRITICAL(&_lock);
+      return true;
+    }
+    removeAt(telemetry, i);
+    break;
+  }
+
+  Ring& ring = _rings[priority];
+  if (ring.count == DASHBOARD_QUEUE_LENGTH) {
+    if (priority != PRIORITY_TELEMETRY) {
+      portEXIT_CRITICAL(&_lock);
+      *overflow = true;
+      return false;
+    }
+    at(ring, 0).message->_holders--;
+    removeAt(ring, 0);
+    ring.stats.dropped++;
+  }
+
+  DashboardQueuedFrame& frame = at(ring, ring.count);
+  message->_holders++;
+  frame.message = message;
+  frame.length = length;
+  frame.clientId = clientId;
+  frame.queuedAt = millis();
+  frame.key = key;
+  ring.count++;
+  if (ring.count > ring.stats.highWater) {
+    ring.stats.highWater = ring.count;
+  }
+  portEXIT_CRITICAL(&_lock);
+  return true;
+}
+
+bool DashboardQueue::peek(uint32_t* clientId) {
+  portENTER_CRITICAL(&_lock);
+  for (int c = 0; c < PRIORITY_COUNT; c++) {
+    if (_rings[c].count > 0) {
+      *clientId = at(_rings[c], 0).clientId;
+      portEXIT_CRITICAL(&_lock);
+      return true;
+    }
+  }
+  portEXIT_CRITICAL(&_lock);
+  return false;
+}
+
+bool DashboardQueue::pop(DashboardQueuedFrame* frame) {
+  portENTER_CRITICAL(&_lock);
+  for (int c = 0; c < PRIORITY_COUNT; c++) {
+    if (_rings[c].count > 0) {
+      take(_rings[c], frame);
+      portEXIT_CRITICAL(&_lock);
+      return true;
+    }
+  }
+  portEXIT_CRITICAL(&_lock);
+  return false;
+}
+
+bool DashboardQueue::popFrom(uint8_t priority, DashboardQueuedFrame* frame) {
+  portENTER_CRITICAL(&_lock);
+  bool taken = _rings[priority].count > 0;
+  if (taken) {
+    take(_rings[priority], frame);
+  }
+  portEXIT_CRITICAL(&_lock);
+  return taken;
+}
+
+void DashboardQueue::release(DashboardQueuedFrame* frame) {
+  releaseBuffer(frame->message);
+  frame->message = NULL;
+}
+
+size_t DashboardQueue::bytesFor(uint32_t clientId) {
+  size_t bytes = 0;
+  portENTER_CRITICAL(&_lock);
+  for (int c = 0; c < PRIORITY_COUNT; c++) {
+    Ring& ring = _rings[c];
+    for (int i = 0; i < ring.count; i++) {
+      if (at(ring, i).clientId == clientId) {
+        bytes += at(ring, i).length;
+      }
+    }
+  }
+  portEXIT_CRITICAL(&_lock);
+  return bytes;
+}
+
+void DashboardQueue::dropFor(uint32_t clientId) {
+  portENTER_CRITICAL(&_lock);
+  for (int c = 0; c < PRIORITY_COUNT; c++) {
+    Ring& ring = _rings[c];
+    for (int i = 0; i < ring.count;) {
+      if (at(ring, i).clientId == clientId) {
+        at(ring, i).message->_holders--;
+        removeAt(ring, i);
+        ring.stats.dropped++;
+      } else {
+        i++;
+      }
+    }
+  }
+  portEXIT_CRITICAL(&_lock);
+}
+
+void DashboardQueue::countSent(uint8_t priority) {
+  portENTER_CRITICAL(&_lock);
+  _rings[priority].stats.sent++;
+  portEXIT_CRITICAL(&_lock);
+}
+
+int DashboardQueue::waiting(uint8_t priority) {
+  int count = 0;
+  portENTER_CRITICAL(&_lock);
+  for (int c = 0; c <= priority && c < PRIORITY_COUNT; c++) {
+    count += _rings[c].count;
+  }
+  portEXIT_CRITICAL(&_lock);
+  return count;
+}
+
+bool DashboardQueue::beginDrain() {
+  portENTER_CRITICAL(&_lock);
+  bool claimed = !_draining;
+  _draining = true;
+  portEXIT_CRITICAL(&_lock);
+  return claimed;
+}
+
+void DashboardQueue::endDrain() {
+  portENTER_CRITICAL(&_lock);
+  _draining = false;
+  portEXIT_CRITICAL(&_lock);
+}
+
+void DashboardQueue::getStats(DashboardQueueStats stats[PRIORITY_COUNT]) {
+  portENTER_CRITICAL(&_lock);
+  for (int c = 0; c < PRIORITY_COUNT; c++) {
+    Ring& ring = _rings[c];
+    stats[c] = ring.stats;
+    stats[c].depth = ring.count;
+    stats[c].averageLatency =
+        ring.stats.sent > 0 ? ring.totalLatency / ring.stats.sent : 0;
+  }
+  portEXIT_CRITICAL(&_lock);
+}
+
+void DashboardQueue::resetStats() {
+  portENTER_CRITICAL(&_lock);
+  for (int c = 0; c < PRIORITY_COUNT; c++) {
+    Ring& ring = _rings[c];
+    memset(&ring.stats, 0, sizeof(ring.stats));
+    ring.stats.highWater = ring.count;
+    ring.totalLatency = 0;
+  }
+  portEXIT_CRITICAL(&_lock);
+}
+
+// Remove the oldest frame of a ring for sending; called with the lock held
+void DashboardQueue::take(Ring& ring, DashboardQueuedFrame* frame) {
+  *frame = at(ring, 0);
+  removeAt(ring, 0);
+
+  uint32_t latency = millis() - frame->queuedAt;
+  ring.stats.sent++;
+  ring.totalLatency += latency;
+  if (latency > ring.stats.maxLatency) {
+    ring.stats.maxLatency = latency;
+  }
+}
+
+// Close the gap left by frame i, keeping the order of the others
+void DashboardQueue::removeAt(Ring& ring, int i) {
+  if (i == 0) {
+    ring.head = (ring.head + 1) % DASHBOARD_QUEUE_LENGTH;
+  } else {
+    for (; i < ring.count - 1; i++) {
+      at(ring, i) = at(ring, i + 1);
+    }
+  }
+  ring.count--;
+}
@@ -3,41 +3,132 @@
 #include <LittleFS.h>
 #include <Update.h>
 #include <WiFi.h>
+#include <math.h>
 #include <stdarg.h>
 
+#if DASHBOARD_ENABLE_HTML
 #include "../include/DashboardHTML.h"
+#endif
 
-// Add converter for ComponentType
-namespace ARDUINOJSON_NAMESPACE {
-template <>
-struct Converter<ComponentType> {
-  static void toJson(ComponentType src, JsonVariant dst) {
-    dst.set(static_cast<int>(src));
-  }
-  static ComponentType fromJson(JsonVariantConst src) {
-    return static_cast<ComponentType>(src.as<int>());
-  }
-};
-}  // namespace ARDUINOJSON_NAMESPACE
+// Reassembly lengths are kept in uint16_t
+static_assert(DASHBOARD_MESSAGE_MAX_SIZE <= 65535,
+              "DASHBOARD_MESSAGE_MAX_SIZE must be at most 65535");
 
 // Constructor
-WebDashboard::WebDashboard() {
+WebDashboardBase::WebDashboardBase(DashboardComponent* components,
+                                   int componentCapacity, WebClient* clients,
+                                   int clientCapacity, LogEntry* logEntries,
+                                   char* logText, int logCapacity,
+                                   int logLength)
+    : _queue()
+#if DASHBOARD_ENABLE_EVENTS
+    , _events(_pool)
+#endif
+{
+  _components = components;
+  _componentCapacity = componentCapacity;
+  _clients = clients;
+  _clientCapacity = clientCapacity;
+#if DASHBOARD_ENABLE_LOGGING
+  _logEntries = logEntries;
+  _logText = logText;
+  _logCapacity = logCapacity;
+  _logLength = logLength;
+  _logEntryCount = 0;
+  _logEntryIndex = 0;
+  memset(_logEntries, 0, logCapacity * sizeof(LogEntry));
+#endif
   _isInitialized = false;
+  _server = NULL;
+  _ws = NULL;
   _debugLoggingEnabled = false;
+  _machineStatePending = false;
+  _schemaHashValid = false;
+  _schemaHash = 0;
+  _batchDepth = 0;
   _lastUpdate = 0;
+  _lastBindingSample = 0;
+  _bindingInterval = DASHBOARD_BINDING_INTERVAL;
+  _segments = NULL;
+  _segmentCount = 0;
+  _maxComponents = componentCapacity;
   _componentCount = 0;
+  _freeList = -1;
+  _freeCount = 0;
+  _pendingCount = 0;
+  _bindingCount = 0;
+  _pinMonitorCount = 0;
+  _idIndex = NULL;
+  _idIndexSize = 0;
+  _idIndexCount = 0;
+  memset(&_stats, 0, sizeof(_stats));
+  _revision = 0;
   _clientCount = 0;
-  _logEntryCount = 0;
-  _logEntryIndex = 0;
   _clientConnectCallback = NULL;
+  _clientBudget = DASHBOARD_CLIENT_BUDGET;
+  memset(_inbound, 0, sizeof(_inbound));
+  _inboundHead = 0;
+  _inboundCount = 0;
+  _inboundLock = portMUX_INITIALIZER_UNLOCKED;
+  _stateChangeCallback = NULL;
+#if DASHBOARD_ENABLE_CONTROLS
+  for (int i = 0; i < DASHBOARD_INPUT_SLOTS; i++) {
+    _inputs[i].index = -1;
+    _inputs[i].pending = false;
+  }
+  _inputLock = portMUX_INITIALIZER_UNLOCKED;
+#endif
+#if DASHBOARD_ENABLE_RPC && DASHBOARD_ENABLE_CONTROLS
+  memset(_heldCalls, 0, sizeof(_heldCalls));
+#endif
+#if DASHBOARD_ENABLE_EVENTS
+  memset(_viewers, 0, sizeof(_viewers));
+#endif
+#if DASHBOARD_ENABLE_REST
+  _snapshot = NULL;
+  _snapshotRevision = 0;
+  _lastSnapshot = 0;
+  _snapshotReaders = 0;
+  _snapshotPolled = false;
+  _lastPoll = 0;
+  _stateEpoch = esp_random();
+  _snapshotLock = portMUX_INITIALIZER_UNLOCKED;
+#endif
+  memset(_components, 0, componentCapacity * sizeof(DashboardComponent));
   memset(_dashboardTitle, 0, sizeof(_dashboardTitle));
   memset(_machineState, 0, sizeof(_machineState));
   strcpy(_machineState, "UNKNOWN");
 }
 
+WebDashboardBase::~WebDashboardBase() {
+  for (int i = 0; i < _componentCount; i++) {
+    DashboardComponent* comp = component(i);
+    if (!comp->schemaStatic) {
+      free((void*)comp->schemaJson);
+    }
+    free(comp->valueJson);
+    free(comp->value.text);
+  }
+  for (int i = 0; i < _segmentCount; i++) {
+    free(_segments[i]);
+  }
+  free(_segments);
+  free(_idIndex);
+  for (int i = 0; i < _clientCount; i++) {
+    releasePartial(&_clients[i]);
+  }
+  for (int i = 0; i < _inboundCount; i++) {
+    _pool.deallocate(
+        _inbound[(_inboundHead + i) % DASHBOARD_INBOUND_MESSAGES].text);
+  }
+#if DASHBOARD_ENABLE_REST
+  free(_snapshot);
+#endif
+}
+
 // Initialization and setup
-bool WebDashboard::begin(const char* ssid, const char* password,
-                         const char* title, int port) {
+bool WebDashboardBase::begin(const char* ssid, const char* password,
+                             const char* title, int port) {
   if (_isInitialized) {
     return false;
   }
@@ -86,6 +177,7 @@ bool WebDashboard::begin(const char* ssid, const char* password,
 
   _server->addHandler(_ws);
 
+#if DASHBOARD_ENABLE_HTML
   // Define web routes
   _server->on("/", HTTP_GET, [this](AsyncWebServerRequest* request) {
     // Replace placeholders in the HTML template
@@ -97,6 +189,21 @@ bool WebDashboard::begin(const char* ssid, const char* password,
 
     request->send(response);
   });
+#endif
+
+#if DASHBOARD_ENABLE_EVENTS
+  // Read-only viewers follow the dashboard as Server-Sent Events
+  _server->on("/events", HTTP_GET, [this](AsyncWebServerRequest* request) {
+    this->handleEventRequest(request);
+  });
+#endif
+
+#if DASHBOARD_ENABLE_REST
+  // Snapshots for pollers; the handler also matches /api/state/{id}
+  _server->on("/api/state", HTTP_GET, [this](AsyncWebServerRequest* request) {
+    this->handleStateRequest(request);
+  });
+#endif
 
   // Handle 404 (Page Not Found) errors
   _server->onNotFound([this](AsyncWebServerRequest* request) {
@@ -116,11 +223,38 @@ bool WebDashboard::begin(const char* ssid, const char* password,
   return true;
 }
 
-void WebDashboard::update() {
+void WebDashboardBase::update() {
   if (!_isInitialized) {
     return;
   }
 
+  // Send frames that waited for busy clients, and free the buffers of the
+  // ones the sockets have sent
+  drainQueue();
+  _queue.collect();
+
+  // Apply the messages and RPC calls received since the last update()
+  serviceMessages();
+
+#if DASHBOARD_ENABLE_CONTROLS
+  // Deliver control values held back while a client was dragging
+  serviceInputs();
+#endif
+
+  // Sample bound variables at their own rate
+  if (_bindingCount > 0 && millis() - _lastBindingSample >= _bindingInterval) {
+    _lastBindingSample = millis();
+    sampleBindings();
+  }
+
+  // Continue schema and state deliveries that didn't fit in one frame
+  serviceSync();
+
+#if DASHBOARD_ENABLE_REST
+  // Serialize the /api/state snapshot here, where the values are written
+  serviceSnapshot();
+#endif
+
   // Update only every DASHBOARD_UPDATE_INTERVAL ms
   if (millis() - _lastUpdate < DASHBOARD_UPDATE_INTERVAL) {
     return;
@@ -128,299 +262,584 @@ void WebDashboard::update() {
 
   _lastUpdate = millis();
 
-  // Clean up inactive clients
-  for (int i = 0; i < _clientCount; i++) {
-    if (_clients[i].active &&
-        (millis() - _clients[i].lastSeen > CLIENT_TIMEOUT)) {
-      _clients[i].active = false;
-      if (_debugLoggingEnabled) {
-        Serial.printf("Client %u timed out\n", _clients[i].id);
-      }
-    }
-  }
+  // Ping quiet clients and close the ones that stopped answering or fell
+  // too far behind
+  serviceClients();
 
+#if DASHBOARD_ENABLE_LOGGING
   // Clean up old logs
   cleanupOldLogs();
+#endif
 
+#if DASHBOARD_ENABLE_PIN_MONITORS
   // Update pin monitors
   uint32_t currentTime = millis();
-  for (int i = 0; i < _componentCount; i++) {
-    if (_components[i].active &&
-        _components[i].type == ComponentType::PIN_MONITOR) {
+  int pinMonitorsSeen = 0;
+  for (int i = 0; i < _componentCount && pinMonitorsSeen < _pinMonitorCount;
+       i++) {
+    DashboardComponent* comp = component(i);
+    if (comp->active && comp->type == ComponentType::PIN_MONITOR) {
+      pinMonitorsSeen++;
+
       // Check if it's time to update this pin
-      if (currentTime - _components[i].config.pinMonitor.lastUpdate >=
-          _components[i].config.pinMonitor.updateInterval) {
-        uint8_t pin = _components[i].config.pinMonitor.pin;
-        bool isAnalog = _components[i].config.pinMonitor.isAnalog;
+      if (currentTime - comp->config.pinMonitor.lastUpdate >=
+          comp->config.pinMonitor.updateInterval) {
+        uint8_t pin = comp->config.pinMonitor.pin;
+        bool isAnalog = comp->config.pinMonitor.isAnalog;
 
         // Read the pin value
         int value = isAnalog ? analogRead(pin) : digitalRead(pin);
 
-        // Update if value has changed
-        if (_components[i].data &&
-            (*_components[i].data)["value"].as<int>() != value) {
-          (*_components[i].data)["value"] = value;
-          broadcastComponentUpdate(_components[i].id);
-        }
+        // Broadcasts only if the value has changed
+        setValue(comp, value);
 
         // Update last update time
-        _components[i].config.pinMonitor.lastUpdate = currentTime;
+        comp->config.pinMonitor.lastUpdate = currentTime;
       }
     }
   }
+#endif
 
   // Broadcast any pending updates
   _ws->cleanupClients();
 }
 
 // Dashboard status methods
-bool WebDashboard::isOnline() {
+bool WebDashboardBase::isOnline() {
   return _isInitialized && (WiFi.status() == WL_CONNECTED);
 }
 
-String WebDashboard::getIPAddress() { return _ipAddress.toString(); }
+String WebDashboardBase::getIPAddress() { return _ipAddress.toString(); }
 
-bool WebDashboard::enableDebugLogging(bool enable) {
+bool WebDashboardBase::enableDebugLogging(bool enable) {
   _debugLoggingEnabled = enable;
   return true;
 }
 
-bool WebDashboard::isDebugLoggingEnabled() { return _debugLoggingEnabled; }
+bool WebDashboardBase::isDebugLoggingEnabled() { return _debugLoggingEnabled; }
+
+const DashboardStats& WebDashboardBase::getStats() {
+  DashboardPoolStats pool = _pool.getStats();
+  _stats.poolAllocations = pool.allocations;
+  _stats.poolFallbacks = pool.fallbacks;
+  _stats.poolInUse = pool.inUse;
+  _stats.poolHighWater = pool.highWater;
+  _stats.socketBuffers = _queue.buffers();
+
+  // Fragmentation shows as a largest block well below the total free heap
+  _stats.freeHeap = ESP.getFreeHeap();
+  _stats.minFreeHeap = ESP.getMinFreeHeap();
+  _stats.largestFreeBlock = heap_caps_get_largest_free_block(MALLOC_CAP_8BIT);
+  _stats.fragmentation =
+      _stats.freeHeap > 0
+          ? 100 - (uint8_t)((uint64_t)_stats.largestFreeBlock * 100 /
+                            _stats.freeHeap)
+          : 0;
+
+  _stats.componentBytes =
+      (_componentCapacity +
+       _segmentCount * DASHBOARD_COMPONENT_SEGMENT_SIZE) *
+          sizeof(DashboardComponent) +
+      _segmentCount * sizeof(DashboardComponent*);
+  _stats.indexBytes = _idIndexSize * sizeof(uint16_t);
+  _stats.stringBytes = _strings.used();
+  _queue.getStats(_stats.queues);
+#if DASHBOARD_ENABLE_EVENTS
+  _events.getStats(&_stats.events);
+#endif
+  _stats.fragmentBytes = 0;
+  for (int i = 0; i < _componentCount; i++) {
+    DashboardComponent* comp = component(i);
+    if (!comp->active) {
+      continue;
+    }
+    if (!comp->schemaStatic) {
+      _stats.fragmentBytes += comp->schemaLength + 1;
+    }
+    _stats.fragmentBytes += comp->valueCapacity + comp->value.capacity;
+  }
+  return _stats;
+}
+
+void WebDashboardBase::resetStats() {
+  memset(&_stats, 0, sizeof(_stats));
+  _pool.resetStats();
+  _queue.resetStats();
+#if DASHBOARD_ENABLE_EVENTS
+  _events.resetStats();
+#endif
+}
 
-// Component management methods
-bool WebDashboard::addButton(const char* id, const char* label,
-                             ButtonCallback callback) {
-  if (_componentCount >= MAX_DASHBOARD_COMPONENTS) {
+bool WebDashboardBase::setMaxComponents(int maxComponents) {
+  // Handles address slots with a 16-bit index
+  if (maxComponents < _componentCount || maxComponents > 32767) {
     return false;
   }
+  _maxComponents = maxComponents;
+  return true;
+}
 
-  DashboardComponent* comp = &_components[_componentCount++];
-  strncpy(comp->id, id, MAX_COMPONENT_ID_LENGTH - 1);
-  strncpy(comp->label, label, sizeof(comp->label) - 1);
-  comp->type = ComponentType::BUTTON;
-  comp->active = true;
-  comp->callback = (void*)callback;
-  comp->data = NULL;
-
-  broadcastComponentUpdate(id);
+int WebDashboardBase::getComponentCount() {
+  return _componentCount - _freeCount;
+}
 
-  return true;
+bool WebDashboardBase::removeComponent(const char* id) {
+  return deleteComponent(findComponent(id));
 }
 
-bool WebDashboard::addToggle(const char* id, const char* label,
-                             bool initialState, ToggleCallback callback) {
-  if (_componentCount >= MAX_DASHBOARD_COMPONENTS) {
-    return false;
+// Component management methods
+ButtonHandle WebDashboardBase::addButton(const char* id, const char* label,
+                                         ButtonCallback callback) {
+  DashboardComponent* comp =
+      createComponent(id, label, ComponentType::BUTTON, (void*)callback);
+  if (!comp) {
+    return ButtonHandle();
   }
 
-  DashboardComponent* comp = &_components[_componentCount++];
-  strncpy(comp->id, id, MAX_COMPONENT_ID_LENGTH - 1);
-  strncpy(comp->label, label, sizeof(comp->label) - 1);
-  comp->type = ComponentType::TOGGLE;
-  comp->active = true;
-  comp->callback = (void*)callback;
+  buildSchemaFragment(comp);
+  broadcastComponentAdded(comp);
+  return handleFor<ComponentType::BUTTON>(comp);
+}
 
-  comp->data = new DynamicJsonDocument(64);
-  if (comp->data) {
-    (*comp->data)["value"] = initialState;
+ToggleHandle WebDashboardBase::addToggle(const char* id, const char* label,
+                                         bool initialState,
+                                         ToggleCallback callback) {
+  DashboardComponent* comp =
+      createComponent(id, label, ComponentType::TOGGLE, (void*)callback);
+  if (!comp) {
+    return ToggleHandle();
   }
 
-  broadcastComponentUpdate(id);
+  comp->value.type = ValueType::BOOL;
+  comp->value.boolValue = initialState;
 
-  return true;
+  buildSchemaFragment(comp);
+  broadcastComponentAdded(comp);
+  return handleFor<ComponentType::TOGGLE>(comp);
 }
 
-bool WebDashboard::addSlider(const char* id, const char* label, int min,
-                             int max, int initialValue, int step,
-                             SliderCallback callback) {
-  if (_componentCount >= MAX_DASHBOARD_COMPONENTS) {
-    return false;
+SliderHandle WebDashboardBase::addSlider(const char* id, const char* label,
+                                         int min, int max, int initialValue,
+                                         int step, SliderCallback callback) {
+  DashboardComponent* comp =
+      createComponent(id, label, ComponentType::SLIDER, (void*)callback);
+  if (!comp) {
+    return SliderHandle();
   }
-
-  DashboardComponent* comp = &_components[_componentCount++];
-  strncpy(comp->id, id, MAX_COMPONENT_ID_LENGTH - 1);
-  strncpy(comp->label, label, sizeof(comp->label) - 1);
-  comp->type = ComponentType::SLIDER;
-  comp->active = true;
-  comp->callback = (void*)callback;
   comp->config.slider.min = min;
   comp->config.slider.max = max;
   comp->config.slider.step = step;
 
-  comp->data = new DynamicJsonDocument(64);
-  if (comp->data) {
-    (*comp->data)["value"] = initialValue;
-    (*comp->data)["min"] = min;
-    (*comp->data)["max"] = max;
-    (*comp->data)["step"] = step;
+  comp->value.type = ValueType::INT;
+  comp->value.intValue = initialValue;
+
+  buildSchemaFragment(comp);
+  broadcastComponentAdded(comp);
+  return handleFor<ComponentType::SLIDER>(comp);
+}
+
+TextInputHandle WebDashboardBase::addTextInput(const char* id,
+                                               const char* label,
+                                               const char* initialValue,
+                                               TextInputCallback callback) {
+  DashboardComponent* comp =
+      createComponent(id, label, ComponentType::TEXT_INPUT, (void*)callback);
+  if (!comp) {
+    return TextInputHandle();
+  }
+
+  comp->value.type = ValueType::STRING;
+  storeValue(comp, initialValue);
+
+  buildSchemaFragment(comp);
+  broadcastComponentAdded(comp);
+  return handleFor<ComponentType::TEXT_INPUT>(comp);
+}
+
+SelectHandle WebDashboardBase::addSelect(const char* id, const char* label,
+                                         const char** options, int optionCount,
+                                         const char* initialValue,
+                                         SelectCallback callback) {
+  DashboardComponent* comp =
+      createComponent(id, label, ComponentType::SELECT, (void*)callback);
+  if (!comp) {
+    return SelectHandle();
+  }
+
+  // Options are kept once, in the string arena
+  comp->config.select.options =
+      _strings.internList(options, optionCount, MAX_COMPONENT_LABEL_LENGTH);
+  if (!comp->config.select.options) {
+    releaseComponent(comp);
+    return SelectHandle();
+  }
+  comp->config.select.optionCount = optionCount;
+
+  comp->value.type = ValueType::STRING;
+  storeValue(comp, initialValue);
+
+  buildSchemaFragment(comp);
+  broadcastComponentAdded(comp);
+  return handleFor<ComponentType::SELECT>(comp);
+}
+
+#if DASHBOARD_ENABLE_PIN_MONITORS
+PinMonitorHandle WebDashboardBase::addPinMonitor(const char* id,
+                                                 const char* label, uint8_t pin,
+                                                 uint8_t mode, bool isAnalog,
+                                                 uint32_t updateInterval) {
+  DashboardComponent* comp =
+      createComponent(id, label, ComponentType::PIN_MONITOR, NULL);
+  if (!comp) {
+    return PinMonitorHandle();
+  }
+
+  // Set pin mode
+  pinMode(pin, mode);
+
+  // Set pin monitor configuration
+  comp->config.pinMonitor.pin = pin;
+  comp->config.pinMonitor.mode = mode;
+  comp->config.pinMonitor.updateInterval = updateInterval;
+  comp->config.pinMonitor.lastUpdate = 0;
+  comp->config.pinMonitor.isAnalog = isAnalog;
+
+  // Read initial pin value
+  comp->value.type = ValueType::INT;
+  comp->value.intValue = isAnalog ? analogRead(pin) : digitalRead(pin);
+  _pinMonitorCount++;
+
+  buildSchemaFragment(comp);
+  broadcastComponentAdded(comp);
+  return handleFor<ComponentType::PIN_MONITOR>(comp);
+}
+#endif
+
+bool WebDashboardBase::addLayout(const DashboardComponentDef* layout,
+                                 int count) {
+  bool success = true;
+  for (int i = 0; i < count; i++) {
+    const DashboardComponentDef& def = layout[i];
+
+    // The compile-time schema carries the whole id, so one that would be
+    // truncated in the slot could never be matched against it
+    if (strlen(def.id) >= MAX_COMPONENT_ID_LENGTH) {
+      if (_debugLoggingEnabled) {
+        Serial.printf("Layout id too long: %s\n", def.id);
+      }
+      success = false;
+      continue;
+    }
+
+    void* callback = NULL;
+    switch (def.type) {
+      case ComponentType::BUTTON:
+        callback = (void*)def.onButton;
+        break;
+      case ComponentType::TOGGLE:
+        callback = (void*)def.onToggle;
+        break;
+      case ComponentType::SLIDER:
+        callback = (void*)def.onSlider;
+        break;
+      case ComponentType::TEXT_INPUT:
+      case ComponentType::SELECT:
+        callback = (void*)def.onText;
+        break;
+      default:
+        break;
+    }
+
+    DashboardComponent* comp =
+        createComponent(def.id, def.label, def.type, callback);
+    if (!comp) {
+      if (_debugLoggingEnabled) {
+        Serial.printf("Cannot add layout component %s\n", def.id);
+      }
+      success = false;
+      continue;
+    }
+
+    switch (def.type) {
+      case ComponentType::TOGGLE:
+        comp->value.type = ValueType::BOOL;
+        comp->value.boolValue = def.initialValue != 0;
+        break;
+      case ComponentType::SLIDER:
+        comp->config.slider.min = def.min;
+        comp->config.slider.max = def.max;
+        comp->config.slider.step = def.step;
+        comp->value.type = ValueType::INT;
+        comp->value.intValue = def.initialValue;
+        break;
+      case ComponentType::TEXT_INPUT:
+      case ComponentType::SELECT:
+        comp->value.type = ValueType::STRING;
+        storeValue(comp, def.initialText);
+        break;
+      default:
+        break;
+    }
+
+    // The schema was assembled by the compiler; use it where it is
+    comp->schemaJson = def.schema;
+    comp->schemaLength = def.schemaLength;
+    comp->idLength = def.idLength;
+    comp->schemaStatic = true;
+    _schemaHashValid = false;
+    _revision++;
+
+    broadcastComponentAdded(comp);
+  }
+  return success;
+}
+
+// Component update methods
+bool WebDashboardBase::updateValue(const char* id, const char* value) {
+  return setValue(findComponent(id), value);
+}
+
+bool WebDashboardBase::updateValue(const char* id, int value) {
+  return setValue(findComponent(id), value);
+}
+
+bool WebDashboardBase::updateValue(const char* id, float value, int precision) {
+  return setValue(findComponent(id), value, precision);
+}
+
+bool WebDashboardBase::updateValue(const char* id, bool value) {
+  return setValue(findComponent(id), value);
+}
+
+bool WebDashboardBase::setValue(DashboardComponent* comp, const char* value) {
+  if (!comp) {
+    return false;
   }
 
-  broadcastComponentUpdate(id);
+  if (storeValue(comp, value)) {
+    broadcastComponentUpdate(comp);
+  }
   return true;
 }
 
-bool WebDashboard::addTextInput(const char* id, const char* label,
-                                const char* initialValue,
-                                TextInputCallback callback) {
-  if (_componentCount >= MAX_DASHBOARD_COMPONENTS) {
+bool WebDashboardBase::setValue(DashboardComponent* comp, int value) {
+  if (!comp) {
     return false;
   }
 
-  DashboardComponent* comp = &_components[_componentCount++];
-  strncpy(comp->id, id, MAX_COMPONENT_ID_LENGTH - 1);
-  strncpy(comp->label, label, sizeof(comp->label) - 1);
-  comp->type = ComponentType::TEXT_INPUT;
-  comp->active = true;
-  comp->callback = (void*)callback;
+  if (storeValue(comp, value)) {
+    broadcastComponentUpdate(comp);
+  }
+  return true;
+}
 
-  comp->data = new DynamicJsonDocument(256);
-  if (comp->data) {
-    (*comp->data)["value"] = initialValue;
+bool WebDashboardBase::setValue(DashboardComponent* comp, float value,
+                                int precision) {
+  if (!comp) {
+    return false;
   }
 
-  broadcastComponentUpdate(id);
+  if (storeValue(comp, value, precision)) {
+    broadcastComponentUpdate(comp);
+  }
   return true;
 }
 
-bool WebDashboard::addSelect(const char* id, const char* label,
-                             const char** options, int optionCount,
-                             const char* initialValue,
-                             SelectCallback callback) {
-  if (_componentCount >= MAX_DASHBOARD_COMPONENTS) {
+bool WebDashboardBase::setValue(DashboardComponent* comp, bool value) {
+  if (!comp) {
     return false;
   }
 
-  DashboardComponent* comp = &_components[_componentCount++];
-  strncpy(comp->id, id, MAX_COMPONENT_ID_LENGTH - 1);
-  strncpy(comp->label, label, sizeof(comp->label) - 1);
-  comp->type = ComponentType::SELECT;
-  comp->active = true;
-  comp->callback = (void*)callback;
+  if (storeValue(comp, value)) {
+    broadcastComponentUpdate(comp);
+  }
+  return true;
+}
 
-  // Store options
-  comp->config.select.options = new char*[optionCount];
-  comp->config.select.optionCount = optionCount;
-  for (int i = 0; i < optionCount; i++) {
-    comp->config.select.options[i] = new char[64];
-    strncpy(comp->config.select.options[i], options[i], 63);
+// The storeValue() overloads write the new value into the component and
+// return true only if it differs from the stored one, so an unchanged update
+// costs a single compare.
+bool WebDashboardBase::storeValue(DashboardComponent* comp, const char* value) {
+  if (!value) {
+    value = "";
+  }
+
+  // Only the part that would be stored counts, so an over-long value sent
+  // again matches its truncated copy
+  size_t length = strnlen(value, MAX_VALUE_LENGTH - 1);
+  if (comp->value.type == ValueType::STRING && comp->value.text &&
+      strncmp(comp->value.text, value, length) == 0 &&
+      comp->value.text[length] == 0) {
+    _stats.updatesSuppressed++;
+    return false;
   }
 
-  comp->data = new DynamicJsonDocument(512);
-  if (comp->data) {
-    (*comp->data)["value"] = initialValue;
-    JsonArray optionsArray = (*comp->data).createNestedArray("options");
-    for (int i = 0; i < optionCount; i++) {
-      optionsArray.add(options[i]);
+  // Grow the text buffer in 16-byte steps so small edits don't reallocate
+  if (length + 1 > comp->value.capacity) {
+    size_t capacity = (length + 16) & ~(size_t)15;
+    char* text = (char*)realloc(comp->value.text, capacity);
+    if (!text) {
+      return false;
     }
+    comp->value.text = text;
+    comp->value.capacity = capacity;
   }
 
-  broadcastComponentUpdate(id);
+  memcpy(comp->value.text, value, length);
+  comp->value.text[length] = 0;
+  comp->value.type = ValueType::STRING;
+  comp->valueDirty = true;
+  _revision++;
+  _stats.updatesSent++;
   return true;
 }
 
-bool WebDashboard::addPinMonitor(const char* id, const char* label, uint8_t pin,
-                                 uint8_t mode, bool isAnalog,
-                                 uint32_t updateInterval) {
-  if (_componentCount >= MAX_DASHBOARD_COMPONENTS) {
+bool WebDashboardBase::storeValue(DashboardComponent* comp, int value) {
+  if (comp->value.type == ValueType::INT && comp->value.intValue == value) {
+    _stats.updatesSuppressed++;
     return false;
   }
 
-  // Set pin mode
-  pinMode(pin, mode);
+  comp->value.type = ValueType::INT;
+  comp->value.intValue = value;
+  comp->valueDirty = true;
+  _revision++;
+  _stats.updatesSent++;
+  return true;
+}
 
-  DashboardComponent* comp = &_components[_componentCount++];
-  strncpy(comp->id, id, MAX_COMPONENT_ID_LENGTH - 1);
-  strncpy(comp->label, label, sizeof(comp->label) - 1);
-  comp->type = ComponentType::PIN_MONITOR;
-  comp->active = true;
-  comp->callback = NULL;
+bool WebDashboardBase::storeValue(DashboardComponent* comp, float value,
+                                  int precision) {
+  // A change is visible only if the value rounds to a different last
+  // displayed digit. roundf() rather than lroundf() so large values can't
+  // overflow a long.
+  static const float scale[] = {1e0f, 1e1f, 1e2f, 1e3f, 1e4f, 1e5f, 1e6f};
+  precision = constrain(precision, 0, 6);
+
+  if (comp->value.type == ValueType::FLOAT &&
+      comp->value.precision == precision &&
+      (roundf(comp->value.floatValue * scale[precision]) ==
+           roundf(value * scale[precision]) ||
+       (isnan(comp->value.floatValue) && isnan(value)))) {
+    _stats.updatesSuppressed++;
+    return false;
+  }
 
-  // Set pin monitor configuration
-  comp->config.pinMonitor.pin = pin;
-  comp->config.pinMonitor.mode = mode;
-  comp->config.pinMonitor.updateInterval = updateInterval;
-  comp->config.pinMonitor.lastUpdate = 0;
-  comp->config.pinMonitor.isAnalog = isAnalog;
+  comp->value.type = ValueType::FLOAT;
+  comp->value.floatValue = value;
+  comp->value.precision = precision;
+  comp->valueDirty = true;
+  _revision++;
+  _stats.updatesSent++;
+  return true;
+}
 
-  // Initialize JSON document for data
-  comp->data = new DynamicJsonDocument(128);
-  if (comp->data) {
-    // Read initial pin value
-    int initialValue = isAnalog ? analogRead(pin) : digitalRead(pin);
-    (*comp->data)["value"] = initialValue;
-    (*comp->data)["min"] = 0;
-    (*comp->data)["max"] =
-        isAnalog ? 4095 : 1;  // ESP32 has 12-bit ADC (0-4095)
+bool WebDashboardBase::storeValue(DashboardComponent* comp, bool value) {
+  if (comp->value.type == ValueType::BOOL && comp->value.boolValue == value) {
+    _stats.updatesSuppressed++;
+    return false;
   }
 
-  broadcastComponentUpdate(id);
+  comp->value.type = ValueType::BOOL;
+  comp->value.boolValue = value;
+  comp->valueDirty = true;
+  _revision++;
+  _stats.updatesSent++;
   return true;
 }
 
-// Component update methods
-bool WebDashboard::updateValue(const char* id, const char* value) {
-  DashboardComponent* comp = findComponent(id);
-  if (!comp || !comp->data) {
+// Variable binding methods
+bool WebDashboardBase::bindValue(const char* id, const int* value,
+                                 portMUX_TYPE* lock) {
+  DashboardComponent* comp;
+  if (!value || !attachBinding(id, BindingType::INT, 0, lock, &comp)) {
     return false;
   }
-
-  (*comp->data)["value"] = value;
-  broadcastComponentUpdate(id);
+  comp->binding.source.intValue = value;
   return true;
 }
 
-bool WebDashboard::updateValue(const char* id, int value) {
-  DashboardComponent* comp = findComponent(id);
-  if (!comp || !comp->data) {
+bool WebDashboardBase::bindValue(const char* id, const float* value,
+                                 int precision, portMUX_TYPE* lock) {
+  DashboardComponent* comp;
+  if (!value ||
+      !attachBinding(id, BindingType::FLOAT, precision, lock, &comp)) {
     return false;
   }
+  comp->binding.source.floatValue = value;
+  return true;
+}
 
-  (*comp->data)["value"] = value;
-  broadcastComponentUpdate(id);
+bool WebDashboardBase::bindValue(const char* id, const bool* value,
+                                 portMUX_TYPE* lock) {
+  DashboardComponent* comp;
+  if (!value || !attachBinding(id, BindingType::BOOL, 0, lock, &comp)) {
+    return false;
+  }
+  comp->binding.source.boolValue = value;
   return true;
 }
 
-bool WebDashboard::updateValue(const char* id, float value, int precision) {
-  DashboardComponent* comp = findComponent(id);
-  if (!comp || !comp->data) {
+bool WebDashboardBase::bindValue(const char* id, IntGetter getter) {
+  DashboardComponent* comp;
+  if (!getter ||
+      !attachBinding(id, BindingType::INT_GETTER, 0, NULL, &comp)) {
     return false;
   }
+  comp->binding.source.intGetter = getter;
+  return true;
+}
 
-  // Use specified precision for floating point values
-  char buffer[16];
-  dtostrf(value, 0, precision, buffer);
-  (*comp->data)["value"] = buffer;
+bool WebDashboardBase::bindValue(const char* id, FloatGetter getter,
+                                 int precision) {
+  DashboardComponent* comp;
+  if (!getter ||
+      !attachBinding(id, BindingType::FLOAT_GETTER, precision, NULL, &comp)) {
+    return false;
+  }
+  comp->binding.source.floatGetter = getter;
+  return true;
+}
 
-  broadcastComponentUpdate(id);
+bool WebDashboardBase::bindValue(const char* id, BoolGetter getter) {
+  DashboardComponent* comp;
+  if (!getter ||
+      !attachBinding(id, BindingType::BOOL_GETTER, 0, NULL, &comp)) {
+    return false;
+  }
+  comp->binding.source.boolGetter = getter;
   return true;
 }
 
-bool WebDashboard::updateValue(const char* id, bool value) {
+bool WebDashboardBase::unbindValue(const char* id) {
   DashboardComponent* comp = findComponent(id);
-  if (!comp || !comp->data) {
+  if (!comp || comp->binding.type == BindingType::NONE) {
     return false;
   }
 
-  (*comp->data)["value"] = value;
-  broadcastComponentUpdate(id);
+  comp->binding.type = BindingType::NONE;
+  _bindingCount--;
   return true;
 }
 
+void WebDashboardBase::setBindingInterval(uint32_t interval) {
+  _bindingInterval = interval;
+}
+
 // State machine methods
-void WebDashboard::setMachineState(const char* state) {
+void WebDashboardBase::setMachineState(const char* state) {
   char oldState[64];
   strncpy(oldState, _machineState, sizeof(oldState) - 1);
 
   strncpy(_machineState, state, sizeof(_machineState) - 1);
+  _revision++;
 
-  // Broadcast the state change
-  DynamicJsonDocument doc(128);
-  doc["type"] = "machine_state";
-  doc["state"] = state;
-
-  String jsonString;
-  serializeJson(doc, jsonString);
-  _ws->textAll(jsonString);
+  // Inside a batch the new state goes out with the commit frame
+  if (_batchDepth > 0) {
+    _machineStatePending = true;
+  } else {
+    broadcastMachineState();
+  }
 
   // Call the callback if set
   if (_stateChangeCallback) {
@@ -428,42 +847,112 @@ void WebDashboard::setMachineState(const char* state) {
   }
 }
 
-const char* WebDashboard::getMachineState() { return _machineState; }
+const char* WebDashboardBase::getMachineState() { return _machineState; }
+
+uint32_t WebDashboardBase::getRevision() { return _revision; }
 
-void WebDashboard::onStateChange(StateChangeCallback callback) {
+void WebDashboardBase::onStateChange(StateChangeCallback callback) {
   _stateChangeCallback = callback;
 }
 
+void WebDashboardBase::onClientConnect(WebClientConnectCallback callback) {
+  _clientConnectCallback = callback;
+}
+
+int WebDashboardBase::getClientCount() { return _ws ? _ws->count() : 0; }
+
+void WebDashboardBase::setClientBudget(size_t bytes) { _clientBudget = bytes; }
+
+// Batch methods
+void WebDashboardBase::beginBatch() { _batchDepth++; }
+
+bool WebDashboardBase::commit() {
+  if (_batchDepth == 0) {
+    return false;
+  }
+
+  if (--_batchDepth > 0) {
+    return true;
+  }
+
+  // Clients that asked for the full state during the batch get it now
+  broadcastPendingComponents();
+  serviceSync();
+  return true;
+}
+
+bool WebDashboardBase::isBatching() { return _batchDepth > 0; }
+
+void WebDashboardBase::broadcastMachineState() {
+  size_t length = 33 + DashboardFrame::jsonStringLength(_machineState);
+  DashboardSocketBuffer* message = makeMessage(length);
+  DashboardFrame frame(_pool, length, storageOf(message));
+  frame.append("{\"type\":\"machine_state\",\"state\":");
+  frame.appendJsonString(_machineState);
+  frame.append('}');
+  sendFrame(ALL_CLIENTS, frame, PRIORITY_CRITICAL, NULL, message);
+  releaseMessage(message);
+}
+
+#if DASHBOARD_ENABLE_LOGGING
 // Logging & alerts
-bool WebDashboard::log(const char* message, uint8_t level) {
+bool WebDashboardBase::log(const char* message, uint8_t level) {
+  if (!_isInitialized) {
+    return false;
+  }
+
+  char* text = logMessage(_logEntryIndex);
+  strncpy(text, message, _logLength - 1);
+  text[_logLength - 1] = '\0';
+  return publishLog(level);
+}
+
+bool WebDashboardBase::logf(uint8_t level, const char* format, ...) {
   if (!_isInitialized) {
     return false;
   }
 
-  // Store the log entry
+  // Format straight into the next log slot
+  va_list args;
+  va_start(args, format);
+  vsnprintf(logMessage(_logEntryIndex), _logLength, format, args);
+  va_end(args);
+
+  return publishLog(level);
+}
+
+// Store the message already written to the next log slot and send it
+bool WebDashboardBase::publishLog(uint8_t level) {
   LogEntry* entry = &_logEntries[_logEntryIndex];
+  const char* message = logMessage(_logEntryIndex);
   entry->active = true;
   entry->level = level;
   entry->timestamp = millis();
-  strncpy(entry->message, message, MAX_LOG_LENGTH - 1);
 
   // Update index for next entry (circular buffer)
-  _logEntryIndex = (_logEntryIndex + 1) % MAX_LOG_ENTRIES;
-  if (_logEntryCount < MAX_LOG_ENTRIES) {
+  _logEntryIndex = (_logEntryIndex + 1) % _logCapacity;
+  if (_logEntryCount < _logCapacity) {
     _logEntryCount++;
   }
 
-  // Send to all log display components
-  DynamicJsonDocument doc(512);
-  doc["type"] = "log";
-  JsonObject entryObj = doc.createNestedObject("entry");
-  entryObj["message"] = message;
-  entryObj["level"] = level;
-  entryObj["timestamp"] = entry->timestamp;
-
-  String jsonString;
-  serializeJson(doc, jsonString);
-  _ws->textAll(jsonString);
+  // Send to all log display components, written straight into the
+  // sockets' buffer
+  char fields[48];
+  int fieldsLength =
+      snprintf(fields, sizeof(fields), ",\"level\":%d,\"timestamp\":%lu",
+               (int)level, (unsigned long)entry->timestamp);
+  size_t length =
+      35 + DashboardFrame::jsonStringLength(message) + fieldsLength;
+  DashboardSocketBuffer* buffer = makeMessage(length);
+  DashboardFrame frame(_pool, length, storageOf(buffer));
+  frame.append("{\"type\":\"log\",\"entry\":{\"message\":");
+  frame.appendJsonString(message);
+  frame.append(fields, fieldsLength);
+  frame.append("}}");
+  sendFrame(ALL_CLIENTS, frame,
+            level == LOG_ERROR ? PRIORITY_CRITICAL : PRIORITY_TELEMETRY, NULL,
+            buffer);
+  releaseMessage(buffer);
 
   // Also output to serial if debug logging is enabled
   if (_debugLoggingEnabled) {
@@ -476,22 +965,13 @@ bool WebDashboard::log(const char* message, uint8_t level) {
 
   return true;
 }
-
-bool WebDashboard::logf(uint8_t level, const char* format, ...) {
-  char buffer[MAX_LOG_LENGTH];
-  va_list args;
-  va_start(args, format);
-  vsnprintf(buffer, MAX_LOG_LENGTH - 1, format, args);
-  va_end(args);
-
-  return log(buffer, level);
-}
+#endif
 
 // Private methods
-void WebDashboard::handleWebSocketEvent(AsyncWebSocket* server,
-                                        AsyncWebSocketClient* client,
-                                        AwsEventType type, void* arg,
-                                        uint8_t* data, size_t len) {
+void WebDashboardBase::handleWebSocketEvent(AsyncWebSocket* server,
+                                            AsyncWebSocketClient* client,
+                                            AwsEventType type, void* arg,
+                                            uint8_t* data, size_t len) {
   if (type == WS_EVT_CONNECT) {
     // New client connected
     uint32_t clientId = client->id();
@@ -502,29 +982,41 @@ void WebDashboard::handleWebSocketEvent(AsyncWebSocket* server,
                     clientIp.toString().c_str());
     }
 
-    // Add to client list or update existing
-    bool clientFound = false;
-    for (int i = 0; i < _clientCount; i++) {
-      if (_clients[i].id == clientId) {
-        _clients[i].active = true;
-        _clients[i].lastSeen = millis();
-        _clients[i].ip = clientIp;
-        clientFound = true;
-        break;
+    // Take the slot of a client that left, or a new one. Clients beyond
+    // the capacity stay untracked and are reached through textAll().
+    WebClient* tracked = NULL;
+    for (int i = 0; i < _clientCount && !tracked; i++) {
+      if (!_clients[i].connected) {
+        tracked = &_clients[i];
       }
     }
-
-    if (!clientFound && _clientCount < MAX_DASHBOARD_CLIENTS) {
-      _clients[_clientCount].id = clientId;
-      _clients[_clientCount].active = true;
-      _clients[_clientCount].lastSeen = millis();
-      _clients[_clientCount].ip = clientIp;
+    if (!tracked && _clientCount < _clientCapacity) {
+      tracked = &_clients[_clientCount];
+      tracked->connected = false;
       _clientCount++;
+    }
 
-      // Call client connect callback if set
-      if (_clientConnectCallback) {
-        _clientConnectCallback(clientIp.toString().c_str());
-      }
+    if (tracked) {
+      tracked->id = clientId;
+      tracked->ip = clientIp;
+      tracked->lastSeen = millis();
+      tracked->lastPing = tracked->lastSeen;
+      tracked->active = true;
+      tracked->groups = GROUP_ALL;
+      tracked->syncStage = SYNC_IDLE;
+      tracked->partial = NULL;
+      tracked->partialLength = 0;
+      tracked->partialCapacity = 0;
+      tracked->receiving = false;
+      tracked->connected = true;
+    } else if (_debugLoggingEnabled) {
+      Serial.printf("WebSocket client #%u not tracked: all %d slots in use\n",
+                    clientId, _clientCapacity);
+    }
+
+    // Call client connect callback if set
+    if (_clientConnectCallback) {
+      _clientConnectCallback(clientIp.toString().c_str());
     }
 
   } else if (type == WS_EVT_DISCONNECT) {
@@ -536,270 +1028,2357 @@ void WebDashboard::handleWebSocketEvent(AsyncWebSocket* server,
     }
 
     // Mark as inactive in client list
-    for (int i = 0; i < _clientCount; i++) {
-      if (_clients[i].id == clientId) {
-        _clients[i].active = false;
-        break;
+    // Free the slot for the next client
+    WebClient* tracked = findClient(clientId);
+    if (tracked) {
+      tracked->active = false;
+      tracked->syncStage = SYNC_IDLE;
+      releasePartial(tracked);
+      tracked->connected = false;
+      while (_clientCount > 0 && !_clients[_clientCount - 1].connected) {
+        _clientCount--;
       }
     }
+    _queue.dropFor(clientId);
+#if DASHBOARD_ENABLE_RPC && DASHBOARD_ENABLE_CONTROLS
+    dropHeldCalls(clientId);
+#endif
+
+  } else if (type == WS_EVT_PONG || type == WS_EVT_DATA) {
+    // Any message, or the answer to a heartbeat ping, shows the client is
+    // still there
+    WebClient* tracked = findClient(client->id());
+    if (tracked) {
+      tracked->lastSeen = millis();
+      tracked->active = true;
+    }
+    if (type == WS_EVT_PONG) {
+      return;
+    }
 
-  } else if (type == WS_EVT_DATA) {
     // Data received from client
     AwsFrameInfo* info = (AwsFrameInfo*)arg;
 
-    if (info->final && info->index == 0 && info->len == len) {
-      // Complete message received
-      data[len] = 0;  // Null terminate the data
-      processWebSocketMessage(client->id(), (const char*)data);
+    if (info->num == 0 && info->final && info->index == 0 &&
+        info->len == len) {
+      // Complete message received; copied for update() to apply, since
+      // the frame is only valid during this event
+      char* text = len <= DASHBOARD_MESSAGE_MAX_SIZE
+                       ? (char*)_pool.allocate(len ? len : 1)
+                       : NULL;
+      if (text) {
+        memcpy(text, data, len);
+      }
+      queueMessage(client->id(), text, len);
+    } else {
+      receivePiece(client->id(), info, data, len);
     }
   }
 }
 
-void WebDashboard::processWebSocketMessage(uint32_t clientId,
-                                           const char* message) {
-  // Update client last seen time
+// Browsers answer pings without the page's involvement, so a passive viewer
+// stays active as long as its connection works. A client that hasn't
+// answered for CLIENT_TIMEOUT is closed; so is a client whose socket is full
+// while more than its budget of frames waits for it, since everyone else's
+// frames of the same class wait behind those. Closing frees the slot once
+// the disconnect arrives, and the page reconnects and reloads its state.
+void WebDashboardBase::serviceClients() {
+  uint32_t now = millis();
   for (int i = 0; i < _clientCount; i++) {
-    if (_clients[i].id == clientId) {
-      _clients[i].lastSeen = millis();
-      break;
+    WebClient& client = _clients[i];
+    if (!client.connected) {
+      continue;
+    }
+    AsyncWebSocketClient* socket = _ws->client(client.id);
+    if (!socket) {
+      continue;
+    }
+
+    uint32_t quiet = now - client.lastSeen;
+    if (quiet > CLIENT_TIMEOUT) {
+      if (client.active) {
+        client.active = false;
+        _stats.clientsTimedOut++;
+        if (_debugLoggingEnabled) {
+          Serial.printf("Client %u timed out\n", client.id);
+        }
+        socket->close();
+      }
+      continue;
+    }
+    if (quiet >= DASHBOARD_PING_INTERVAL &&
+        now - client.lastPing >= DASHBOARD_PING_INTERVAL) {
+      client.lastPing = now;
+      socket->ping();
     }
-  }
 
-  // Parse the JSON message
-  DynamicJsonDocument doc(1024);
-  DeserializationError error = deserializeJson(doc, message);
+    // Frames for every client only wait on the clients that aren't ready,
+    // so they count against those
+    if (clientReady(client.id)) {
+      continue;
+    }
+    size_t held = _queue.bytesFor(client.id) + _queue.bytesFor(ALL_CLIENTS) +
+                  client.partialLength;
+    if (held > _clientBudget && client.active) {
+      client.active = false;
+      _stats.clientsEvicted++;
+      if (_debugLoggingEnabled) {
+        Serial.printf("Client %u closed: %u bytes waiting\n", client.id,
+                      (unsigned int)held);
+      }
+      _queue.dropFor(client.id);
+      socket->close();
+    }
+  }
+}
 
-  if (error) {
-    if (_debugLoggingEnabled) {
-      Serial.printf("Failed to parse WebSocket message: %s\n", error.c_str());
+// Collect a message that arrives in several frames, or in several TCP
+// segments of one frame. Each tracked client has one buffer from the pool,
+// grown as pieces arrive and released once the message has been handled.
+// A message longer than DASHBOARD_MESSAGE_MAX_SIZE is skipped up to its
+// last piece, so a client can't hold more than that.
+void WebDashboardBase::receivePiece(uint32_t clientId, AwsFrameInfo* info,
+                                    uint8_t* data, size_t len) {
+  bool first = info->num == 0 && info->index == 0;
+  bool last = info->final && info->index + len == info->len;
+
+  WebClient* client = findClient(clientId);
+  if (!client) {
+    if (last) {
+      _stats.messagesDropped++;
     }
     return;
   }
 
-  // Process based on message type
-  const char* type = doc["type"];
-
-  if (strcmp(type, "request_full_update") == 0) {
-    // Client requested a full dashboard update
-    broadcastDashboardUpdate(true);
-
-  } else if (strcmp(type, "button_press") == 0) {
-    // Button press event
-    const char* id = doc["id"];
-    DashboardComponent* comp = findComponent(id);
+  if (first) {
+    client->receiving = true;
+    client->discarding = false;
+    client->partialLength = 0;
+  } else if (!client->receiving) {
+    // The rest of a message whose start we didn't see
+    return;
+  }
 
-    if (comp && comp->type == ComponentType::BUTTON && comp->callback) {
-      ButtonCallback callback = (ButtonCallback)comp->callback;
-      callback(id);
+  if (!client->discarding) {
+    size_t length = client->partialLength + len;
+    if (length > client->partialCapacity &&
+        length <= DASHBOARD_MESSAGE_MAX_SIZE) {
+      char* grown = (char*)_pool.reallocate(client->partial, length);
+      if (grown) {
+        size_t capacity = _pool.capacityOf(grown);
+        client->partial = grown;
+        client->partialCapacity = capacity > length ? capacity : length;
+      }
     }
 
-  } else if (strcmp(type, "toggle_change") == 0) {
-    // Toggle change event
-    const char* id = doc["id"];
-    bool value = doc["value"];
+    if (length > DASHBOARD_MESSAGE_MAX_SIZE ||
+        length > client->partialCapacity) {
+      if (_debugLoggingEnabled) {
+        Serial.printf("Dropped WebSocket message from #%u at %u bytes\n",
+                      clientId, (unsigned int)length);
+      }
+      client->discarding = true;
+      releasePartial(client);
+      _stats.messagesDropped++;
+    } else {
+      memcpy(client->partial + client->partialLength, data, len);
+      client->partialLength = length;
+    }
+  }
 
-    DashboardComponent* comp = findComponent(id);
+  if (last) {
+    client->receiving = false;
+    if (!client->discarding) {
+      // The queue takes the buffer over; the next message grows a new one
+      _stats.messagesReassembled++;
+      queueMessage(clientId, client->partial, client->partialLength);
+      client->partial = NULL;
+      client->partialCapacity = 0;
+    }
+    releasePartial(client);
+  }
+}
 
-    if (comp && comp->type == ComponentType::TOGGLE && comp->data) {
-      // Update internal state
-      (*comp->data)["value"] = value;
+void WebDashboardBase::releasePartial(WebClient* client) {
+  _pool.deallocate(client->partial);
+  client->partial = NULL;
+  client->partialLength = 0;
+  client->partialCapacity = 0;
+}
 
-      // Call callback if set
-      if (comp->callback) {
-        ToggleCallback callback = (ToggleCallback)comp->callback;
-        callback(id, value);
-      }
+#if DASHBOARD_ENABLE_RPC
+// Whether a frame holds RPC calls: a batch, or an object naming "jsonrpc"
+static bool isCallFrame(const char* message, size_t length) {
+  static const char marker[] = "\"jsonrpc\"";
+  const char* end = message + length;
+  const char* start = message;
+  while (start < end && isspace((unsigned char)*start)) {
+    start++;
+  }
+  if (start < end && *start == '[') {
+    return true;
+  }
+  for (; end - start >= (ptrdiff_t)(sizeof(marker) - 1); start++) {
+    if (memcmp(start, marker, sizeof(marker) - 1) == 0) {
+      return true;
+    }
+  }
+  return false;
+}
 
-      // Broadcast the update to all clients
-      broadcastComponentUpdate(id);
+// Answers without an id to give: the frame or a call in a batch was not
+// JSON-RPC at all, or there was no room to take it
+static const char RPC_PARSE_ERROR[] =
+    "{\"jsonrpc\":\"2.0\",\"id\":null,"
+    "\"error\":{\"code\":-32700,\"message\":\"Parse error\"}}";
+static const char RPC_INVALID_REQUEST[] =
+    "{\"jsonrpc\":\"2.0\",\"id\":null,"
+    "\"error\":{\"code\":-32600,\"message\":\"Invalid Request\"}}";
+static const char RPC_SERVER_BUSY[] =
+    "{\"jsonrpc\":\"2.0\",\"id\":null,"
+    "\"error\":{\"code\":-32000,\"message\":\"Server busy\"}}";
+#endif
+
+// Hand a message from the web server's task to update(). Applying it reads
+// and writes component values, callbacks and client state, which all
+// belong to the loop task. The queue takes text, a pool buffer, over; a
+// message that can't be kept is dropped, or refused if it is an RPC call.
+void WebDashboardBase::queueMessage(uint32_t clientId, char* text,
+                                    size_t length) {
+  bool queued = false;
+  if (text) {
+    portENTER_CRITICAL(&_inboundLock);
+    if (_inboundCount < DASHBOARD_INBOUND_MESSAGES) {
+      InboundMessage& message =
+          _inbound[(_inboundHead + _inboundCount) % DASHBOARD_INBOUND_MESSAGES];
+      message.clientId = clientId;
+      message.text = text;
+      message.length = length;
+      _inboundCount++;
+      queued = true;
     }
+    portEXIT_CRITICAL(&_inboundLock);
+  }
+  if (queued) {
+    return;
+  }
 
-  } else if (strcmp(type, "slider_change") == 0) {
-    // Slider change event
-    const char* id = doc["id"];
-    int value = doc["value"];
+  _stats.messagesDropped++;
+#if DASHBOARD_ENABLE_RPC
+  if (text && isCallFrame(text, length)) {
+    _stats.rpcErrors++;
+    DashboardFrame response(_pool, sizeof(RPC_SERVER_BUSY));
+    response.append(RPC_SERVER_BUSY);
+    sendFrame(clientId, response, PRIORITY_CONTROL);
+  }
+#endif
+  _pool.deallocate(text);
+}
 
-    DashboardComponent* comp = findComponent(id);
+// Apply the messages received since the last call, in the order they came
+void WebDashboardBase::serviceMessages() {
+  while (true) {
+    InboundMessage message;
+    message.text = NULL;
+    portENTER_CRITICAL(&_inboundLock);
+    if (_inboundCount > 0) {
+      message = _inbound[_inboundHead];
+      _inboundHead = (_inboundHead + 1) % DASHBOARD_INBOUND_MESSAGES;
+      _inboundCount--;
+    }
+    portEXIT_CRITICAL(&_inboundLock);
 
-    if (comp && comp->type == ComponentType::SLIDER && comp->data) {
-      // Update internal state
-      (*comp->data)["value"] = value;
+    if (!message.text) {
+      return;
+    }
+    processWebSocketMessage(message.clientId, message.text, message.length);
+    _pool.deallocate(message.text);
+  }
+}
 
-      // Call callback if set
-      if (comp->callback) {
-        SliderCallback callback = (SliderCallback)comp->callback;
-        callback(id, value);
-      }
+void WebDashboardBase::processWebSocketMessage(uint32_t clientId,
+                                               char* message, size_t length) {
+#if DASHBOARD_ENABLE_RPC
+  // Only a batch of RPC calls is an array
+  bool call = isCallFrame(message, length);
+  char* start = message;
+  while (start < message + length && isspace((unsigned char)*start)) {
+    start++;
+  }
+  if (start < message + length && *start == '[') {
+    handleBatch(clientId, start, message + length);
+    return;
+  }
+#endif
+
+  // Parsed in place: the message's strings point into the frame, and
+  // nothing is allocated
+  DashboardMessage msg;
+  if (!msg.parse(message, length)) {
+#if DASHBOARD_ENABLE_RPC
+    if (call) {
+      _stats.rpcErrors++;
+      DashboardFrame response(_pool, sizeof(RPC_PARSE_ERROR));
+      response.append(RPC_PARSE_ERROR);
+      sendFrame(clientId, response, PRIORITY_CONTROL);
+      return;
+    }
+#endif
+    if (_debugLoggingEnabled) {
+      Serial.println("Failed to parse WebSocket message");
+    }
+    return;
+  }
 
-      // Broadcast the update to all clients
-      broadcastComponentUpdate(id);
+#if DASHBOARD_ENABLE_RPC
+  if (msg.rpc) {
+    DashboardComponent* comp = NULL;
+    uint8_t outcome = handleCall(clientId, msg, &comp);
+    if (outcome != MESSAGE_UNANSWERED) {
+      DashboardFrame response(_pool, 128);
+      appendResponse(response, msg.requestId, msg.requestNumber,
+                     msg.requestNull, comp, outcome);
+      sendFrame(clientId, response, PRIORITY_CONTROL);
     }
+    return;
+  }
+#else
+  // Without answers a call is no use to the script that sent it
+  if (msg.rpc) {
+    return;
+  }
+#endif
+
+  applyMessage(clientId, msg, NULL);
+}
+
+// Act on a message from the page or an RPC call. The component it named is
+// returned through target, if given, for the call's answer.
+uint8_t WebDashboardBase::applyMessage(uint32_t clientId,
+                                       const DashboardMessage& msg,
+                                       DashboardComponent** target) {
+  DashboardComponent* comp = msg.id ? findComponent(msg.id) : NULL;
+  if (target) {
+    *target = comp;
+  }
 
-  } else if (strcmp(type, "text_input_change") == 0) {
-    // Text input change event
-    const char* id = doc["id"];
-    const char* value = doc["value"];
+  // Process based on message type
+  switch (msg.type) {
+    case DashboardMessageType::REQUEST_FULL_UPDATE:
+      handleFullUpdateRequest(clientId, msg.schemaHash ? msg.schemaHash : "");
+      return MESSAGE_APPLIED;
+
+    case DashboardMessageType::SUBSCRIBE:
+      handleSubscribe(clientId, msg.groups >= 0 ? msg.groups : GROUP_ALL);
+      return MESSAGE_APPLIED;
+
+    case DashboardMessageType::GET_VALUE:
+      return comp ? MESSAGE_APPLIED : MESSAGE_INVALID;
+
+#if DASHBOARD_ENABLE_CONTROLS
+    case DashboardMessageType::BUTTON_PRESS:
+      // Button press event
+      if (!comp || comp->type != ComponentType::BUTTON) {
+        return MESSAGE_INVALID;
+      }
+      if (comp->callback) {
+        ButtonCallback callback = (ButtonCallback)comp->callback;
+        callback(comp->id);
+      }
+      return MESSAGE_APPLIED;
 
-    DashboardComponent* comp = findComponent(id);
+    case DashboardMessageType::TOGGLE_CHANGE: {
+      // Toggle change event
+      if (!comp || comp->type != ComponentType::TOGGLE) {
+        return MESSAGE_INVALID;
+      }
 
-    if (comp && comp->type == ComponentType::TEXT_INPUT && comp->data) {
       // Update internal state
-      (*comp->data)["value"] = value;
+      bool changed = storeValue(comp, msg.flag);
 
       // Call callback if set
       if (comp->callback) {
-        TextInputCallback callback = (TextInputCallback)comp->callback;
-        callback(id, value);
+        ToggleCallback callback = (ToggleCallback)comp->callback;
+        callback(comp->id, msg.flag);
       }
 
-      // Broadcast the update to all clients
-      broadcastComponentUpdate(id);
+      // Broadcast the update to the other clients
+      if (changed) {
+        broadcastComponentUpdate(comp, PRIORITY_CONTROL, clientId);
+      }
+      return MESSAGE_APPLIED;
     }
-  } else if (strcmp(type, "select_change") == 0) {
-    // Select change event
-    const char* id = doc["id"];
-    const char* value = doc["value"];
 
-    DashboardComponent* comp = findComponent(id);
+    case DashboardMessageType::SLIDER_CHANGE:
+      // Slider change event
+      if (!comp || comp->type != ComponentType::SLIDER) {
+        return MESSAGE_INVALID;
+      }
+
+      // Update internal state; the callback and the other clients get the
+      // value at most once per DASHBOARD_INPUT_WINDOW
+      return handleInput(clientId, comp, storeValue(comp, msg.number), &msg)
+                 ? MESSAGE_HELD
+                 : MESSAGE_APPLIED;
+
+    case DashboardMessageType::TEXT_INPUT_CHANGE:
+      // Text input change event
+      if (!comp || comp->type != ComponentType::TEXT_INPUT) {
+        return MESSAGE_INVALID;
+      }
+
+      // Update internal state; the callback and the other clients get the
+      // value at most once per DASHBOARD_INPUT_WINDOW
+      return handleInput(clientId, comp, storeValue(comp, msg.text), &msg)
+                 ? MESSAGE_HELD
+                 : MESSAGE_APPLIED;
+
+    case DashboardMessageType::SELECT_CHANGE: {
+      // Select change event
+      if (!comp || comp->type != ComponentType::SELECT) {
+        return MESSAGE_INVALID;
+      }
 
-    if (comp && comp->type == ComponentType::SELECT && comp->data) {
       // Update internal state
-      (*comp->data)["value"] = value;
+      bool changed = storeValue(comp, msg.text);
 
       // Call callback if set
       if (comp->callback) {
         SelectCallback callback = (SelectCallback)comp->callback;
-        callback(id, value);
+        callback(comp->id, msg.text);
+      }
+
+      // Broadcast the update to the other clients
+      if (changed) {
+        broadcastComponentUpdate(comp, PRIORITY_CONTROL, clientId);
       }
+      return MESSAGE_APPLIED;
+    }
+#endif
 
-      // Broadcast the update to all clients
-      broadcastComponentUpdate(id);
+    default:
+      // Unknown messages, and control events when controls are compiled out
+      return MESSAGE_UNKNOWN;
+  }
+}
+
+#if DASHBOARD_ENABLE_RPC
+// Apply a batch of calls parsed one at a time from the frame, and answer
+// the ones that completed at once together in a single array frame. Calls
+// held for coalescing are answered on their own later, so a client matches
+// answers by id rather than by order.
+void WebDashboardBase::handleBatch(uint32_t clientId, char* batch,
+                                   char* end) {
+  DashboardFrame response(_pool, 256);
+  response.append('[');
+  int calls = 0;
+  int answers = 0;
+
+  DashboardMessage call;
+  char* cursor = batch;
+  while (call.parseNext(&cursor, end)) {
+    calls++;
+    DashboardComponent* comp = NULL;
+    uint8_t outcome = MESSAGE_UNANSWERED;
+    if (call.rpc) {
+      outcome = handleCall(clientId, call, &comp);
+    } else {
+      _stats.rpcCalls++;
+      _stats.rpcErrors++;
+    }
+    if (call.rpc && outcome == MESSAGE_UNANSWERED) {
+      continue;
+    }
+
+    if (answers++ > 0) {
+      response.append(',');
+    }
+    if (call.rpc) {
+      appendResponse(response, call.requestId, call.requestNumber,
+                     call.requestNull, comp, outcome);
+    } else {
+      response.append(RPC_INVALID_REQUEST);
+    }
+  }
+
+  // An empty or unreadable batch is answered with a single error. Calls
+  // before a syntax error were applied, and get theirs with it.
+  const char* error = !cursor ? RPC_PARSE_ERROR
+                      : calls == 0 ? RPC_INVALID_REQUEST
+                                   : NULL;
+  if (error && calls == 0) {
+    _stats.rpcErrors++;
+    DashboardFrame single(_pool, sizeof(RPC_INVALID_REQUEST));
+    single.append(error);
+    sendFrame(clientId, single, PRIORITY_CONTROL);
+    return;
+  }
+  if (error) {
+    _stats.rpcErrors++;
+    if (answers++ > 0) {
+      response.append(',');
     }
+    response.append(error);
+  }
+
+  if (answers == 0) {
+    // Only notifications and held calls
+    return;
   }
+  response.append(']');
+  sendFrame(clientId, response, PRIORITY_CONTROL);
 }
 
-void WebDashboard::broadcastDashboardUpdate(bool fullUpdate) {
-  DynamicJsonDocument doc(8192);  // Large document for full dashboard
-  doc["type"] = "full_update";
-  doc["machineState"] = _machineState;
+// Apply one call; returns the outcome to answer it with now, or
+// MESSAGE_UNANSWERED
+uint8_t WebDashboardBase::handleCall(uint32_t clientId,
+                                     const DashboardMessage& call,
+                                     DashboardComponent** target) {
+  _stats.rpcCalls++;
+  uint8_t outcome = applyMessage(clientId, call, target);
+  if (!call.hasRequestId || outcome == MESSAGE_HELD) {
+    return MESSAGE_UNANSWERED;
+  }
+  return outcome;
+}
 
-  JsonArray componentsArray = doc.createNestedArray("components");
+// Append the answer to a call: the component's value as it stands after the
+// call, true for calls about no component, or an error
+void WebDashboardBase::appendResponse(DashboardFrame& out,
+                                      const char* requestId,
+                                      int32_t requestNumber,
+                                      bool requestNull,
+                                      DashboardComponent* comp,
+                                      uint8_t outcome) {
+  out.append("{\"jsonrpc\":\"2.0\",\"id\":");
+  if (requestId) {
+    out.appendJsonString(requestId);
+  } else if (requestNull) {
+    out.append("null");
+  } else {
+    out.append((int)requestNumber);
+  }
 
-  // Add all active components
-  for (int i = 0; i < _componentCount; i++) {
-    if (_components[i].active) {
-      JsonObject component = componentsArray.createNestedObject();
-      component["id"] = _components[i].id;
-      component["type"] = _components[i].type;
-      component["label"] = _components[i].label;
-
-      // Add component-specific configuration
-      switch (_components[i].type) {
-        case ComponentType::SLIDER: {
-          JsonObject config = component.createNestedObject("config");
-          config["min"] = _components[i].config.slider.min;
-          config["max"] = _components[i].config.slider.max;
-          config["step"] = _components[i].config.slider.step;
-          break;
-        }
+  if (outcome == MESSAGE_APPLIED) {
+    out.append(",\"result\":");
+    if (comp) {
+      refreshValueFragment(comp);
+      appendComponentValue(out, comp);
+    } else {
+      out.append("true");
+    }
+  } else {
+    _stats.rpcErrors++;
+    out.append(outcome == MESSAGE_UNKNOWN
+                   ? ",\"error\":{\"code\":-32601,"
+                     "\"message\":\"Method not found\"}"
+                   : ",\"error\":{\"code\":-32602,"
+                     "\"message\":\"Invalid params\"}");
+  }
+  out.append('}');
+}
+#endif
+
+#if DASHBOARD_ENABLE_CONTROLS
+// A client changed a slider or text input. The first value after a quiet
+// period is delivered right away. Values arriving within
+// DASHBOARD_INPUT_WINDOW of it replace each other, and update() delivers
+// the last one when the window ends, so a drag costs at most one callback
+// and one broadcast per window however fast the browser sends. An RPC call
+// whose value is held back waits with it; returns true if it does.
+bool WebDashboardBase::handleInput(uint32_t clientId, DashboardComponent* comp,
+                                   bool changed,
+                                   const DashboardMessage* call) {
+  _stats.inputsReceived++;
+  int index = indexOf(comp);
+  uint32_t now = millis();
 
-        case ComponentType::SELECT: {
-          JsonObject config = component.createNestedObject("config");
-          JsonArray options = config.createNestedArray("options");
-          for (int j = 0; j < _components[i].config.select.optionCount; j++) {
-            options.add(_components[i].config.select.options[j]);
-          }
-          break;
-        }
-      }
+  portENTER_CRITICAL(&_inputLock);
+  InputSlot* slot = NULL;
+  InputSlot* unused = NULL;
+  for (int i = 0; i < DASHBOARD_INPUT_SLOTS; i++) {
+    InputSlot& candidate = _inputs[i];
+    if (candidate.index == index &&
+        candidate.generation == comp->generation) {
+      slot = &candidate;
+      break;
+    }
+    if (!unused && (candidate.index < 0 ||
+                    (!candidate.pending &&
+                     now - candidate.deliveredAt >= DASHBOARD_INPUT_WINDOW))) {
+      unused = &candidate;
+    }
+  }
 
-      // Add component data
-      if (_components[i].data) {
-        for (JsonPair kv : _components[i].data->as<JsonObject>()) {
-          component[kv.key().c_str()] = kv.value();
-        }
-      }
+  if (slot && now - slot->deliveredAt < DASHBOARD_INPUT_WINDOW) {
+    slot->clientId = clientId;
+    slot->pending = true;
+    slot->changed |= changed;
+#if DASHBOARD_ENABLE_RPC
+    // Held under the same lock, so the delivery can't slip in between
+    bool held = call && call->hasRequestId &&
+                holdCall(index, comp->generation, clientId, *call);
+#else
+    bool held = false;
+#endif
+    portEXIT_CRITICAL(&_inputLock);
+    _stats.inputsCoalesced++;
+    return held;
+  }
+
+  // Deliver now and open a window. Without a free slot the value is
+  // delivered uncoalesced.
+  if (slot) {
+    changed |= slot->changed;
+  } else {
+    slot = unused;
+  }
+  if (slot) {
+    slot->index = index;
+    slot->generation = comp->generation;
+    slot->deliveredAt = now;
+    slot->pending = false;
+    slot->changed = false;
+  }
+  portEXIT_CRITICAL(&_inputLock);
+  deliverInput(clientId, comp, changed);
+  return false;
+}
+
+// Hand the current value of a control to its callback and to the clients
+// other than the one that set it, which already shows it
+void WebDashboardBase::deliverInput(uint32_t clientId, DashboardComponent* comp,
+                                    bool changed) {
+  if (comp->callback) {
+    if (comp->type == ComponentType::SLIDER) {
+      SliderCallback callback = (SliderCallback)comp->callback;
+      callback(comp->id, comp->value.intValue);
+    } else {
+      TextInputCallback callback = (TextInputCallback)comp->callback;
+      callback(comp->id, comp->value.text ? comp->value.text : "");
     }
   }
 
-  // Add recent logs
-  if (fullUpdate && _logEntryCount > 0) {
-    JsonArray logsArray = doc.createNestedArray("logs");
+  if (changed) {
+    broadcastComponentUpdate(comp, PRIORITY_CONTROL, clientId);
+  }
 
-    // Add most recent logs first (up to 50)
-    int count = min(_logEntryCount, 50);
-    for (int i = 0; i < count; i++) {
-      int index = (_logEntryIndex - 1 - i + MAX_LOG_ENTRIES) % MAX_LOG_ENTRIES;
-      if (_logEntries[index].active) {
-        JsonObject entry = logsArray.createNestedObject();
-        entry["message"] = _logEntries[index].message;
-        entry["level"] = _logEntries[index].level;
-        entry["timestamp"] = _logEntries[index].timestamp;
+#if DASHBOARD_ENABLE_RPC
+  // Calls that set the value can be answered now
+  answerHeldCalls(indexOf(comp), comp->generation, comp);
+#endif
+}
+
+// Deliver the values held back for controls whose window has ended
+void WebDashboardBase::serviceInputs() {
+  uint32_t now = millis();
+  for (int i = 0; i < DASHBOARD_INPUT_SLOTS; i++) {
+    portENTER_CRITICAL(&_inputLock);
+    InputSlot slot = _inputs[i];
+    bool due =
+        slot.pending && now - slot.deliveredAt >= DASHBOARD_INPUT_WINDOW;
+    if (due) {
+      _inputs[i].deliveredAt = now;
+      _inputs[i].pending = false;
+      _inputs[i].changed = false;
+    }
+    portEXIT_CRITICAL(&_inputLock);
+
+    if (!due) {
+      continue;
+    }
+
+    // The component may have been removed in the meantime
+    DashboardComponent* comp =
+        slot.index < _componentCount ? component(slot.index) : NULL;
+    bool present =
+        comp && comp->active && comp->generation == slot.generation;
+    if (present) {
+      deliverInput(slot.clientId, comp, slot.changed);
+    }
+#if DASHBOARD_ENABLE_RPC
+    if (!present) {
+      // Calls that set the value are told it is gone
+      answerHeldCalls(slot.index, slot.generation, NULL);
+    }
+#endif
+  }
+}
+
+#if DASHBOARD_ENABLE_RPC
+// Keep a call until the value it set is delivered; called with _inputLock
+// held. Returns false if it has to be answered now instead.
+bool WebDashboardBase::holdCall(int index, uint16_t generation,
+                                uint32_t clientId,
+                                const DashboardMessage& call) {
+  if (call.requestId && strlen(call.requestId) >= DASHBOARD_RPC_ID_LENGTH) {
+    return false;
+  }
+  for (int i = 0; i < DASHBOARD_RPC_PENDING; i++) {
+    HeldCall& held = _heldCalls[i];
+    if (held.clientId != 0) {
+      continue;
+    }
+    held.clientId = clientId;
+    held.index = index;
+    held.generation = generation;
+    held.textId = call.requestId != NULL;
+    held.number = call.requestNumber;
+    held.nullId = call.requestNull;
+    if (held.textId) {
+      strcpy(held.text, call.requestId);
+    }
+    return true;
+  }
+  return false;
+}
+
+// Answer the calls held for a component's value, each in a frame of its
+// own, with the value the callback got; comp is NULL if the component was
+// removed before the value was delivered
+void WebDashboardBase::answerHeldCalls(int index, uint16_t generation,
+                                       DashboardComponent* comp) {
+  // One at a time, so the answer is sent outside the lock
+  while (true) {
+    HeldCall held;
+    held.clientId = 0;
+    portENTER_CRITICAL(&_inputLock);
+    for (int i = 0; i < DASHBOARD_RPC_PENDING; i++) {
+      if (_heldCalls[i].clientId != 0 && _heldCalls[i].index == index &&
+          _heldCalls[i].generation == generation) {
+        held = _heldCalls[i];
+        _heldCalls[i].clientId = 0;
+        break;
       }
     }
+    portEXIT_CRITICAL(&_inputLock);
+
+    if (held.clientId == 0) {
+      return;
+    }
+    _stats.rpcHeld++;
+    DashboardFrame response(_pool, 128);
+    appendResponse(response, held.textId ? held.text : NULL, held.number,
+                   held.nullId, comp,
+                   comp ? MESSAGE_APPLIED : MESSAGE_INVALID);
+    sendFrame(held.clientId, response, PRIORITY_CONTROL);
+  }
+}
+
+// Forget the calls of a client that disconnected
+void WebDashboardBase::dropHeldCalls(uint32_t clientId) {
+  portENTER_CRITICAL(&_inputLock);
+  for (int i = 0; i < DASHBOARD_RPC_PENDING; i++) {
+    if (_heldCalls[i].clientId == clientId) {
+      _heldCalls[i].clientId = 0;
+    }
+  }
+  portEXIT_CRITICAL(&_inputLock);
+}
+#endif
+#endif
+
+// Client requested a full dashboard update. It presents the hash of the
+// schema it has cached, and the schema is only resent if that differs.
+// Large dashboards don't fit in one frame, so the client gets a cursor and
+// serviceSync() sends the schema and then the state a page at a time.
+void WebDashboardBase::handleFullUpdateRequest(uint32_t clientId,
+                                               const char* clientHash) {
+  uint32_t hash = schemaHash();
+  char hashText[9];
+  snprintf(hashText, sizeof(hashText), "%08x", (unsigned int)hash);
+  bool schemaCurrent = strcmp(clientHash, hashText) == 0;
+
+  WebClient* client = findClient(clientId);
+  if (!client) {
+    // Untracked clients (more than the client capacity) get every page at
+    // once
+    for (int offset = schemaCurrent ? -1 : 0; offset >= 0;) {
+      offset = sendSchema(clientId, offset);
+    }
+    for (int offset = 0; offset >= 0;) {
+      offset = sendState(clientId, offset);
+    }
+    return;
   }
 
-  String jsonString;
-  serializeJson(doc, jsonString);
-  _ws->textAll(jsonString);
+  client->syncStage = schemaCurrent ? SYNC_STATE : SYNC_SCHEMA;
+  client->syncOffset = 0;
+  client->syncHash = hash;
+  serviceSync();
 }
 
-void WebDashboard::broadcastComponentUpdate(const char* componentId) {
-  DashboardComponent* comp = findComponent(componentId);
-  if (!comp) {
+// Client switched tabs and now shows the given groups. Updates to groups it
+// wasn't subscribed to were not sent to it, so their current values follow
+// as value pages.
+void WebDashboardBase::handleSubscribe(uint32_t clientId, uint8_t groups) {
+  WebClient* client = findClient(clientId);
+  if (!client) {
+    // Untracked clients keep receiving everything
+    return;
+  }
+
+  uint8_t added = groups & GROUP_ALL & ~client->groups;
+  client->groups = groups & GROUP_ALL;
+  if (added == 0) {
+    return;
+  }
+
+  // A full state in progress covers every group already
+  if (client->syncStage == SYNC_IDLE) {
+    client->syncGroups = added;
+  } else if (client->syncStage == SYNC_VALUES) {
+    client->syncGroups |= added;
+  } else {
     return;
   }
+  client->syncStage = SYNC_VALUES;
+  client->syncOffset = 0;
+  serviceSync();
+}
 
-  DynamicJsonDocument doc(2048);
-  doc["type"] = "component_update";
+// Send the next schema or state page to every client that is waiting for
+// one. During a batch the state waits for the commit, so clients never see
+// a half-applied batch.
+void WebDashboardBase::serviceSync() {
+  // Pages are the lowest class; they wait for everything else to go out
+  if (!_ws || _batchDepth > 0 || _queue.waiting(PRIORITY_BULK) > 0) {
+    return;
+  }
 
-  JsonObject component = doc.createNestedObject("component");
-  component["id"] = comp->id;
-  component["type"] = comp->type;
-  component["label"] = comp->label;
+  for (int i = 0; i < _clientCount; i++) {
+    WebClient& client = _clients[i];
+    if (!client.active || client.syncStage == SYNC_IDLE) {
+      continue;
+    }
 
-  // Add component-specific configuration
-  switch (comp->type) {
-    case ComponentType::SLIDER: {
-      JsonObject config = component.createNestedObject("config");
-      config["min"] = comp->config.slider.min;
-      config["max"] = comp->config.slider.max;
-      config["step"] = comp->config.slider.step;
-      break;
+    AsyncWebSocketClient* socket = _ws->client(client.id);
+    if (!socket) {
+      client.syncStage = SYNC_IDLE;
+      continue;
     }
 
-    case ComponentType::SELECT: {
-      JsonObject config = component.createNestedObject("config");
-      JsonArray options = config.createNestedArray("options");
-      for (int j = 0; j < comp->config.select.optionCount; j++) {
-        options.add(comp->config.select.options[j]);
+    // A page only goes out once the previous ones have drained, so a large
+    // dashboard doesn't fill the send queue and the heap with pages
+    if (socket->queueLen() > 1) {
+      continue;
+    }
+
+    sendSyncPage(client.id, &client.syncStage, client.syncGroups,
+                 &client.syncOffset, &client.syncHash);
+  }
+
+#if DASHBOARD_ENABLE_EVENTS
+  // Viewers of /events get the schema and state the same way, then follow
+  // the frames published from then on
+  for (uint32_t id = _events.accept(); id != 0; id = _events.accept()) {
+    EventViewer& viewer = _viewers[id & 0xFF];
+    viewer.id = id;
+    viewer.syncOffset = 0;
+    viewer.syncHash = 0;
+    viewer.syncStage = SYNC_SCHEMA;
+  }
+  for (int i = 0; i < DASHBOARD_EVENT_VIEWERS; i++) {
+    EventViewer& viewer = _viewers[i];
+    if (viewer.syncStage == SYNC_IDLE) {
+      continue;
+    }
+    if (!_events.connected(viewer.id)) {
+      viewer.syncStage = SYNC_IDLE;
+      continue;
+    }
+    if (!_events.ready(viewer.id)) {
+      continue;
+    }
+
+    sendSyncPage(viewer.id, &viewer.syncStage, GROUP_ALL, &viewer.syncOffset,
+                 &viewer.syncHash);
+    if (viewer.syncStage == SYNC_IDLE) {
+      _events.stream(viewer.id);
+    }
+  }
+#endif
+}
+
+// Send the next page of a delivery and advance it
+void WebDashboardBase::sendSyncPage(uint32_t clientId, uint8_t* stage,
+                                    uint8_t groups, uint16_t* offset,
+                                    uint32_t* hash) {
+  // The schema changed under an ongoing delivery; start over. Value pages
+  // don't depend on it, since added components are sent as they come.
+  if (*stage != SYNC_VALUES && *hash != schemaHash()) {
+    *hash = schemaHash();
+    *stage = SYNC_SCHEMA;
+    *offset = 0;
+  }
+
+  int next;
+  if (*stage == SYNC_SCHEMA) {
+    next = sendSchema(clientId, *offset);
+  } else if (*stage == SYNC_STATE) {
+    next = sendState(clientId, *offset);
+  } else {
+    next = sendValues(clientId, groups, *offset);
+  }
+  if (next >= 0) {
+    *offset = next;
+  } else if (*stage == SYNC_SCHEMA) {
+    *stage = SYNC_STATE;
+    *offset = 0;
+  } else {
+    *stage = SYNC_IDLE;
+  }
+}
+
+#if DASHBOARD_ENABLE_EVENTS
+// Answer a request for /events with a stream that stays open. The viewer's
+// schema and state pages are sent from serviceSync().
+void WebDashboardBase::handleEventRequest(AsyncWebServerRequest* request) {
+  // update() takes the new viewer from _events and starts its schema and
+  // state; _viewers belongs to the loop task
+  uint32_t id = _events.open();
+  if (id == 0) {
+    request->send(503, "text/plain", "Too many viewers");
+    return;
+  }
+
+  AsyncWebServerResponse* response = request->beginChunkedResponse(
+      "text/event-stream",
+      [this, id](uint8_t* buffer, size_t maxLength, size_t index) -> size_t {
+        return _events.fill(id, buffer, maxLength);
+      });
+  response->addHeader("Cache-Control", "no-cache");
+  request->onDisconnect([this, id]() { _events.close(id); });
+  request->send(response);
+
+  if (_debugLoggingEnabled) {
+    Serial.printf("Event viewer #%u connected\n", (unsigned int)(id & 0xFF));
+  }
+}
+#endif
+
+#if DASHBOARD_ENABLE_REST
+// Find the object of one component in a snapshot, returning where it
+// starts and its length, or NULL if the snapshot has no such component
+static const char* findSnapshotEntry(DashboardPool& pool, const char* snapshot,
+                                     const char* id, size_t* length) {
+  DashboardFrame needle(pool, 6 + DashboardFrame::jsonStringLength(id));
+  needle.append("{\"id\":");
+  needle.appendJsonString(id);
+  if (needle.overflowed()) {
+    return NULL;
+  }
+
+  // Quotes inside string values are escaped, so the needle only matches
+  // the start of an entry; the next character rules out longer ids
+  const char* start = strstr(snapshot, needle.c_str());
+  while (start && start[needle.length()] != ',' &&
+         start[needle.length()] != '}') {
+    start = strstr(start + 1, needle.c_str());
+  }
+  if (!start) {
+    return NULL;
+  }
+
+  bool inString = false;
+  for (const char* p = start + needle.length(); *p; p++) {
+    if (inString) {
+      if (*p == '\\' && p[1]) {
+        p++;
+      } else if (*p == '"') {
+        inString = false;
       }
-      break;
+    } else if (*p == '"') {
+      inString = true;
+    } else if (*p == '}') {
+      *length = p + 1 - start;
+      return start;
+    }
+  }
+  return NULL;
+}
+
+// Answer /api/state with the values of all components and the machine
+// state, or /api/state/{id} with one component's value. Both come from the
+// snapshot update() serialized, never from the components themselves,
+// which the loop task may be writing meanwhile. The ETag is the snapshot's
+// revision, so a poller that already has it gets a 304 without a copy.
+void WebDashboardBase::handleStateRequest(AsyncWebServerRequest* request) {
+  _stats.stateRequests++;
+  const char* id = request->url().c_str() + strlen("/api/state");
+  id = *id == '/' ? id + 1 : "";
+
+  // update() only replaces the snapshot while nobody is reading it
+  uint32_t now = millis();
+  portENTER_CRITICAL(&_snapshotLock);
+  _snapshotPolled = true;
+  _lastPoll = now;
+  const char* snapshot = _snapshot;
+  uint32_t revision = _snapshotRevision;
+  if (snapshot) {
+    _snapshotReaders++;
+  }
+  portEXIT_CRITICAL(&_snapshotLock);
+
+  if (!snapshot) {
+    // The next update() serializes one now that it has been asked for;
+    // hold the response open until then rather than turning the poller away
+    StateWait* wait = new StateWait();
+    wait->id = id;
+    wait->ready = false;
+    AsyncWebServerResponse* response = request->beginChunkedResponse(
+        "application/json",
+        [this, wait](uint8_t* buffer, size_t maxLength, size_t index) {
+          return fillState(wait, buffer, maxLength, index);
+        });
+    response->addHeader("Cache-Control", "no-cache");
+    request->onDisconnect([wait]() { delete wait; });
+    request->send(response);
+    return;
+  }
+
+  char etag[24];
+  snprintf(etag, sizeof(etag), "\"%08x-%lx\"", (unsigned int)_stateEpoch,
+           (unsigned long)revision);
+  int status = 304;
+  String body;
+  AsyncWebHeader* match = request->getHeader("If-None-Match");
+  if (!match || !strstr(match->value().c_str(), etag)) {
+    status = copySnapshot(snapshot, id, body);
+  }
+
+  portENTER_CRITICAL(&_snapshotLock);
+  _snapshotReaders--;
+  portEXIT_CRITICAL(&_snapshotLock);
+
+  if (status == 404) {
+    request->send(404, "application/json",
+                  "{\"error\":\"Unknown component\"}");
+    return;
+  }
+  if (status == 503) {
+    request->send(503, "text/plain", "Out of memory");
+    return;
+  }
+  if (status == 304) {
+    _stats.stateNotModified++;
+  }
+
+  AsyncWebServerResponse* response =
+      status == 304 ? request->beginResponse(304)
+                    : request->beginResponse(200, "application/json", body);
+  response->addHeader("ETag", etag);
+  if (status == 200) {
+    response->addHeader("Cache-Control", "no-cache");
+  }
+  request->send(response);
+}
+
+// Copy the whole snapshot, or the entry of component id if it is not
+// empty, into body. The caller holds a reader on the snapshot. Returns the
+// HTTP status to answer with.
+int WebDashboardBase::copySnapshot(const char* snapshot, const char* id,
+                                   String& body) {
+  if (*id) {
+    size_t length = 0;
+    const char* entry = findSnapshotEntry(_pool, snapshot, id, &length);
+    if (!entry) {
+      return 404;
+    }
+    DashboardFrame frame(_pool, length);
+    frame.append(entry, length);
+    if (frame.overflowed()) {
+      return 503;
     }
+    body = frame.c_str();
+  } else {
+    body = snapshot;
   }
+  return body.length() > 0 ? 200 : 503;
+}
+
+// Fill the body of a request that arrived before the first snapshot: try
+// again until update() has serialized one, then copy from it and send the
+// copy. The 200 has gone out already, so errors are told in the body.
+size_t WebDashboardBase::fillState(StateWait* wait, uint8_t* buffer,
+                                   size_t maxLength, size_t index) {
+  if (!wait->ready) {
+    uint32_t now = millis();
+    portENTER_CRITICAL(&_snapshotLock);
+    _snapshotPolled = true;
+    _lastPoll = now;
+    const char* snapshot = _snapshot;
+    if (snapshot) {
+      _snapshotReaders++;
+    }
+    portEXIT_CRITICAL(&_snapshotLock);
+
+    if (!snapshot) {
+      return RESPONSE_TRY_AGAIN;
+    }
+    int status = copySnapshot(snapshot, wait->id.c_str(), wait->body);
+
+    portENTER_CRITICAL(&_snapshotLock);
+    _snapshotReaders--;
+    portEXIT_CRITICAL(&_snapshotLock);
 
-  // Add component data
-  if (comp->data) {
-    for (JsonPair kv : comp->data->as<JsonObject>()) {
-      component[kv.key().c_str()] = kv.value();
+    if (status == 404) {
+      wait->body = "{\"error\":\"Unknown component\"}";
+    } else if (status == 503) {
+      wait->body = "{\"error\":\"Out of memory\"}";
     }
+    wait->ready = true;
   }
 
-  String jsonString;
-  serializeJson(doc, jsonString);
-  _ws->textAll(jsonString);
+  size_t length = wait->body.length() - index;
+  if (length > maxLength) {
+    length = maxLength;
+  }
+  memcpy(buffer, wait->body.c_str() + index, length);
+  return length;
+}
+
+// Keep the snapshot current while someone polls it: serialize it again when
+// the revision has moved on, at most every DASHBOARD_UPDATE_INTERVAL ms.
+// Once nobody has asked for DASHBOARD_SNAPSHOT_TIMEOUT ms, free it and stop
+// until the next request.
+void WebDashboardBase::serviceSnapshot() {
+  uint32_t now = millis();
+  char* idle = NULL;
+  portENTER_CRITICAL(&_snapshotLock);
+  bool polled = _snapshotPolled;
+  bool current = _snapshot && _snapshotRevision == _revision;
+  if (polled && now - _lastPoll >= DASHBOARD_SNAPSHOT_TIMEOUT &&
+      _snapshotReaders == 0) {
+    polled = false;
+    _snapshotPolled = false;
+    idle = _snapshot;
+    _snapshot = NULL;
+  }
+  portEXIT_CRITICAL(&_snapshotLock);
+  free(idle);
+
+  if (!polled || current ||
+      (_snapshot && now - _lastSnapshot < DASHBOARD_UPDATE_INTERVAL)) {
+    return;
+  }
+  if (buildSnapshot(_revision)) {
+    _lastSnapshot = now;
+  }
 }
 
-WebDashboard::DashboardComponent* WebDashboard::findComponent(const char* id) {
+// Serialize the /api/state body into a new buffer, sized exactly so it is
+// written in place, and swap it in unless a request is still reading the
+// old one, in which case the next update() tries again
+bool WebDashboardBase::buildSnapshot(uint32_t revision) {
+  char head[24];
+  int headLength = snprintf(head, sizeof(head), "{\"revision\":%lu,",
+                            (unsigned long)revision);
+  size_t length = headLength + 15 +
+                  DashboardFrame::jsonStringLength(_machineState) + 15 + 2;
+  int count = 0;
   for (int i = 0; i < _componentCount; i++) {
-    if (_components[i].active && strcmp(_components[i].id, id) == 0) {
-      return &_components[i];
+    DashboardComponent* comp = component(i);
+    if (comp->active) {
+      refreshValueFragment(comp);
+      length += valueLength(comp) + (count > 0 ? 1 : 0);
+      count++;
     }
   }
-  return NULL;
+
+  char* snapshot = (char*)malloc(length + 1);
+  if (!snapshot) {
+    return false;
+  }
+
+  DashboardFrame frame(_pool, length, snapshot);
+  frame.append(head, headLength);
+  frame.append("\"machineState\":");
+  frame.appendJsonString(_machineState);
+  frame.append(",\"components\":[");
+  bool first = true;
+  for (int i = 0; i < _componentCount; i++) {
+    DashboardComponent* comp = component(i);
+    if (comp->active) {
+      if (!first) {
+        frame.append(',');
+      }
+      appendComponentValue(frame, comp);
+      first = false;
+    }
+  }
+  frame.append("]}");
+  if (frame.overflowed()) {
+    free(snapshot);
+    return false;
+  }
+
+  portENTER_CRITICAL(&_snapshotLock);
+  bool swapped = _snapshotReaders == 0;
+  if (swapped) {
+    char* old = _snapshot;
+    _snapshot = snapshot;
+    _snapshotRevision = revision;
+    snapshot = old;
+  }
+  portEXIT_CRITICAL(&_snapshotLock);
+
+  free(snapshot);
+  if (swapped) {
+    _stats.stateSnapshots++;
+  }
+  return swapped;
+}
+#endif
+
+// Send the schema of the components from slot offset on, as many as fit in
+// a page. Returns the slot the next page starts at, or -1 after the last.
+int WebDashboardBase::sendSchema(uint32_t clientId, int offset) {
+  // Size the page up front so the concatenation below never reallocates
+  size_t length = 96;
+  int end = offset;
+  int count = 0;
+  for (; end < _componentCount; end++) {
+    DashboardComponent* comp = component(end);
+    if (!comp->active) {
+      continue;
+    }
+    if (count > 0 && length + comp->schemaLength + 3 > DASHBOARD_PAGE_SIZE) {
+      break;
+    }
+    length += comp->schemaLength + 3;
+    count++;
+  }
+  bool more = end < _componentCount;
+
+  char hash[9];
+  snprintf(hash, sizeof(hash), "%08x", (unsigned int)schemaHash());
+
+  DashboardFrame frame(_pool, length);
+  frame.append("{\"type\":\"schema\",\"hash\":\"");
+  frame.append(hash);
+  if (!DashboardFeatures::controls) {
+    // Clients disable their inputs, since the device would ignore them
+    frame.append("\",\"readOnly\":true");
+  } else {
+    frame.append('"');
+  }
+  if (offset > 0) {
+    frame.append(",\"offset\":");
+    frame.append(offset);
+  }
+  if (more) {
+    frame.append(",\"more\":true");
+  }
+  frame.append(",\"components\":[");
+  bool first = true;
+  for (int i = offset; i < end; i++) {
+    DashboardComponent* comp = component(i);
+    if (comp->active) {
+      if (!first) {
+        frame.append(',');
+      }
+      frame.append('{');
+      frame.append(comp->schemaJson, comp->schemaLength);
+      frame.append('}');
+      first = false;
+    }
+  }
+  frame.append("]}");
+  sendFrame(clientId, frame, PRIORITY_BULK);
+  return more ? end : -1;
+}
+
+// Send the values of the components from slot offset on, as many as fit in
+// a page. The first page also carries the machine state and the last one
+// the recent logs. Returns the slot the next page starts at, or -1 after
+// the last.
+int WebDashboardBase::sendState(uint32_t clientId, int offset) {
+  // Size the page up front so the concatenation below never reallocates
+  size_t length = 96 + strlen(_machineState) * 2;
+  int end = offset;
+  int count = 0;
+  for (; end < _componentCount; end++) {
+    DashboardComponent* comp = component(end);
+    if (!comp->active) {
+      continue;
+    }
+    refreshValueFragment(comp);
+    if (count > 0 && length + valueLength(comp) + 1 > DASHBOARD_PAGE_SIZE) {
+      break;
+    }
+    length += valueLength(comp) + 1;
+    count++;
+  }
+  bool more = end < _componentCount;
+
+#if DASHBOARD_ENABLE_LOGGING
+  // Logs are sized by their actual length, not the worst case
+  int logCount = more ? 0 : min(_logEntryCount, 50);
+  for (int i = 0; i < logCount; i++) {
+    int index = (_logEntryIndex - 1 - i + _logCapacity) % _logCapacity;
+    length += strlen(logMessage(index)) + 48;
+  }
+#endif
+
+  char hash[9];
+  snprintf(hash, sizeof(hash), "%08x", (unsigned int)schemaHash());
+
+  DashboardFrame frame(_pool, length);
+  frame.append("{\"type\":\"state\",\"hash\":\"");
+  frame.append(hash);
+  frame.append('"');
+  if (offset > 0) {
+    frame.append(",\"offset\":");
+    frame.append(offset);
+  } else {
+    frame.append(",\"machineState\":");
+    frame.appendJsonString(_machineState);
+  }
+  if (more) {
+    frame.append(",\"more\":true");
+  }
+
+  // Add the values of the active components on this page
+  frame.append(",\"values\":[");
+  bool first = true;
+  for (int i = offset; i < end; i++) {
+    DashboardComponent* comp = component(i);
+    if (comp->active) {
+      if (!first) {
+        frame.append(',');
+      }
+      appendComponentValue(frame, comp);
+      first = false;
+    }
+  }
+  frame.append(']');
+
+#if DASHBOARD_ENABLE_LOGGING
+  // Add recent logs
+  if (logCount > 0) {
+    frame.append(",\"logs\":[");
+    first = true;
+
+    // Add most recent logs first (up to 50)
+    for (int i = 0; i < logCount; i++) {
+      int index = (_logEntryIndex - 1 - i + _logCapacity) % _logCapacity;
+      if (_logEntries[index].active) {
+        if (!first) {
+          frame.append(',');
+        }
+        frame.append("{\"message\":");
+        frame.appendJsonString(logMessage(index));
+        frame.append(",\"level\":");
+        frame.append((int)_logEntries[index].level);
+        frame.append(",\"timestamp\":");
+        frame.append((uint32_t)_logEntries[index].timestamp);
+        frame.append('}');
+        first = false;
+      }
+    }
+    frame.append(']');
+  }
+#endif
+
+  frame.append('}');
+  sendFrame(clientId, frame, PRIORITY_BULK);
+  return more ? end : -1;
+}
+
+// Send the values of the components in the given groups from slot offset
+// on, as a batch_update page. Returns the slot the next page starts at, or
+// -1 after the last.
+int WebDashboardBase::sendValues(uint32_t clientId, uint8_t groups,
+                                 int offset) {
+  size_t length = 64;
+  int end = offset;
+  int count = 0;
+  for (; end < _componentCount; end++) {
+    DashboardComponent* comp = component(end);
+    if (!comp->active || !(groupOf(comp) & groups)) {
+      continue;
+    }
+    refreshValueFragment(comp);
+    if (count > 0 && length + valueLength(comp) + 1 > DASHBOARD_PAGE_SIZE) {
+      break;
+    }
+    length += valueLength(comp) + 1;
+    count++;
+  }
+  if (count == 0) {
+    return -1;
+  }
+
+  DashboardFrame frame(_pool, length);
+  frame.append("{\"type\":\"batch_update\",\"components\":[");
+  bool first = true;
+  for (int i = offset; i < end; i++) {
+    DashboardComponent* comp = component(i);
+    if (comp->active && (groupOf(comp) & groups)) {
+      if (!first) {
+        frame.append(',');
+      }
+      appendComponentValue(frame, comp);
+      first = false;
+    }
+  }
+  frame.append("]}");
+  sendFrame(clientId, frame, PRIORITY_BULK);
+  return end < _componentCount ? end : -1;
+}
+
+void WebDashboardBase::sendFrame(uint32_t clientId,
+                                 const DashboardFrame& frame, uint8_t priority,
+                                 const void* key,
+                                 DashboardSocketBuffer* message) {
+  if (!_ws) {
+    // Components can be added before begin(); there is no one to tell yet
+    return;
+  }
+
+  if (frame.overflowed()) {
+    // A truncated frame would be invalid JSON, so drop it instead
+    if (_debugLoggingEnabled) {
+      Serial.println("Dropped dashboard frame: out of memory");
+    }
+    return;
+  }
+
+#if DASHBOARD_ENABLE_EVENTS
+  // Pages for one viewer of /events; frames for everyone reach the viewers
+  // through the shared ring
+  if (clientId & DASHBOARD_EVENT_CLIENT) {
+    _events.send(clientId, frame.c_str(), frame.length());
+    return;
+  }
+  if (clientId == ALL_CLIENTS) {
+    _events.publish(frame.c_str(), frame.length());
+  }
+#endif
+
+  DashboardSocketBuffer* shared = shareFrame(frame, message);
+  if (!shared) {
+    if (_debugLoggingEnabled) {
+      Serial.println("Dropped dashboard frame: no message buffer");
+    }
+    return;
+  }
+
+  // Straight to the socket while nothing is waiting
+  if (_queue.waiting(PRIORITY_COUNT - 1) == 0 && clientReady(clientId)) {
+    transmit(clientId, shared);
+    _queue.countSent(priority);
+    releaseMessage(shared);
+    return;
+  }
+
+  bool overflow;
+  while (!_queue.push(priority, clientId, shared, key, &overflow) &&
+         overflow) {
+    // This class doesn't drop frames; make room by sending its oldest
+    DashboardQueuedFrame oldest;
+    if (!_queue.popFrom(priority, &oldest)) {
+      transmit(clientId, shared);
+      _queue.countSent(priority);
+      break;
+    }
+    transmit(oldest.clientId, oldest.message);
+    _queue.release(&oldest);
+  }
+  releaseMessage(shared);
+  drainQueue();
+}
+
+// Send waiting frames, highest class first, for as long as the client of
+// the next one has room. Frames behind a busy client wait with it, so each
+// client still gets the frames of a class in order.
+void WebDashboardBase::drainQueue() {
+  if (!_ws || !_queue.beginDrain()) {
+    return;
+  }
+
+  uint32_t clientId;
+  DashboardQueuedFrame frame;
+  while (_queue.peek(&clientId) && clientReady(clientId) &&
+         _queue.pop(&frame)) {
+    transmit(frame.clientId, frame.message);
+    _queue.release(&frame);
+  }
+  _queue.endDrain();
+}
+
+// Whether a client's socket holds fewer than DASHBOARD_SOCKET_QUEUE_DEPTH
+// frames. A frame for all clients waits for the busiest tracked one.
+bool WebDashboardBase::clientReady(uint32_t clientId) {
+  if (clientId != ALL_CLIENTS) {
+    AsyncWebSocketClient* socket = _ws->client(clientId);
+    return !socket || socket->queueLen() < DASHBOARD_SOCKET_QUEUE_DEPTH;
+  }
+
+  for (int i = 0; i < _clientCount; i++) {
+    if (!_clients[i].connected) {
+      continue;
+    }
+    AsyncWebSocketClient* socket = _ws->client(_clients[i].id);
+    if (socket && socket->queueLen() >= DASHBOARD_SOCKET_QUEUE_DEPTH) {
+      return false;
+    }
+  }
+  return true;
+}
+
+// Every client a frame goes to is handed the same buffer. The socket
+// library counts the messages it makes from it, and the queue frees it in
+// collect() once they are sent.
+void WebDashboardBase::transmit(uint32_t clientId,
+                                AsyncWebSocketMessageBuffer* message) {
+  if (clientId == ALL_CLIENTS) {
+    _ws->textAll(message);
+    return;
+  }
+  AsyncWebSocketClient* socket = _ws->client(clientId);
+  if (socket) {
+    socket->text(message);
+  }
+}
+
+// Get a socket message buffer of exactly length bytes for a frame to be
+// written into, so it is sent without a copy; NULL if there is no socket
+// or no memory, and the frame then takes a pool buffer. The buffer is held
+// until releaseMessage().
+DashboardSocketBuffer* WebDashboardBase::makeMessage(size_t length) {
+  if (!_ws) {
+    return NULL;
+  }
+  DashboardSocketBuffer* message = _queue.makeBuffer(length);
+  if (!message) {
+    return NULL;
+  }
+  _stats.socketFrames++;
+  return message;
+}
+
+// Get a held message buffer holding a frame: the given one if the frame was
+// written into it, else a copy of the frame
+DashboardSocketBuffer* WebDashboardBase::shareFrame(
+    const DashboardFrame& frame, DashboardSocketBuffer* message) {
+  if (frame.overflowed()) {
+    return NULL;
+  }
+  if (message && message->length() == frame.length()) {
+    _queue.holdBuffer(message);
+    return message;
+  }
+
+  message = makeMessage(frame.length());
+  if (message) {
+    memcpy(message->get(), frame.c_str(), frame.length());
+    _stats.socketBytesCopied += frame.length();
+  }
+  return message;
+}
+
+void WebDashboardBase::releaseMessage(DashboardSocketBuffer* message) {
+  if (message) {
+    _queue.releaseBuffer(message);
+  }
+}
+
+// Send a frame to the clients subscribed to any of the groups, other than
+// except (0 for none), in one textAll() when that is every client
+void WebDashboardBase::sendToGroups(uint8_t groups,
+                                    const DashboardFrame& frame,
+                                    uint8_t priority, const void* key,
+                                    uint32_t except,
+                                    DashboardSocketBuffer* message) {
+  bool everyone = true;
+  for (int i = 0; i < _clientCount; i++) {
+    if (_clients[i].connected &&
+        (!(_clients[i].groups & groups) || _clients[i].id == except)) {
+      everyone = false;
+    }
+  }
+
+  // Untracked clients can only be reached by textAll(), which then echoes
+  // the value to its sender too
+  if (everyone || hasUntrackedClients()) {
+    sendFrame(ALL_CLIENTS, frame, priority, key, message);
+    return;
+  }
+
+  // One buffer for all of them
+  DashboardSocketBuffer* shared = shareFrame(frame, message);
+  for (int i = 0; i < _clientCount; i++) {
+    if (_clients[i].connected && (_clients[i].groups & groups) &&
+        _clients[i].id != except) {
+      sendFrame(_clients[i].id, frame, priority, key, shared);
+    }
+  }
+  releaseMessage(shared);
+#if DASHBOARD_ENABLE_EVENTS
+  // Viewers of /events show every group
+  _events.publish(frame.c_str(), frame.length());
+#endif
+}
+
+// Groups at least one client is subscribed to
+uint8_t WebDashboardBase::subscribedGroups() {
+  if (hasUntrackedClients()) {
+    return GROUP_ALL;
+  }
+#if DASHBOARD_ENABLE_EVENTS
+  if (_events.count() > 0) {
+    return GROUP_ALL;
+  }
+#endif
+
+  uint8_t groups = 0;
+  for (int i = 0; i < _clientCount; i++) {
+    if (_clients[i].connected) {
+      groups |= _clients[i].groups;
+    }
+  }
+  return groups;
+}
+
+// Clients beyond the client capacity aren't tracked, so what they show is
+// unknown and they are sent everything
+bool WebDashboardBase::hasUntrackedClients() {
+  if (!_ws) {
+    return false;
+  }
+
+  int connected = 0;
+  for (int i = 0; i < _clientCount; i++) {
+    if (_clients[i].connected) {
+      connected++;
+    }
+  }
+  return _ws->count() > (size_t)connected;
+}
+
+// The group of a component is the tab the page shows it on
+uint8_t WebDashboardBase::groupOf(DashboardComponent* comp) {
+  switch (comp->type) {
+    case ComponentType::PIN_MONITOR:
+      return GROUP_MONITORING;
+    case ComponentType::BUTTON:
+      return GROUP_CONTROLS;
+    default:
+      return GROUP_SETTINGS;
+  }
+}
+
+uint32_t WebDashboardBase::schemaHash() {
+  if (_schemaHashValid) {
+    return _schemaHash;
+  }
+
+  // FNV-1a over the schema fragments of all active components, in order
+  uint32_t hash = 2166136261u;
+  for (int i = 0; i < _componentCount; i++) {
+    DashboardComponent* comp = component(i);
+    if (!comp->active) {
+      continue;
+    }
+    for (uint16_t j = 0; j < comp->schemaLength; j++) {
+      hash = (hash ^ (uint8_t)comp->schemaJson[j]) * 16777619u;
+    }
+    hash = (hash ^ '\n') * 16777619u;
+  }
+
+  // A build with a different feature set must not reuse a cached schema
+  hash = (hash ^ (DashboardFeatures::controls ? 'c' : 'r')) * 16777619u;
+
+  _schemaHash = hash;
+  _schemaHashValid = true;
+  return hash;
+}
+
+void WebDashboardBase::broadcastComponentAdded(DashboardComponent* comp) {
+  refreshValueFragment(comp);
+
+  // New components carry their schema, so clients can create them in place
+  DashboardFrame frame(_pool, componentLength(comp) + 40);
+  frame.append("{\"type\":\"component_update\",\"component\":");
+  appendComponent(frame, comp);
+  frame.append('}');
+  sendFrame(ALL_CLIENTS, frame, PRIORITY_CONTROL);
+}
+
+void WebDashboardBase::broadcastComponentRemoved(const char* id) {
+  DashboardFrame frame(_pool, strlen(id) + 40);
+  frame.append("{\"type\":\"component_removed\",\"id\":");
+  frame.appendJsonString(id);
+  frame.append('}');
+  sendFrame(ALL_CLIENTS, frame, PRIORITY_CONTROL);
+}
+
+void WebDashboardBase::broadcastComponentUpdate(DashboardComponent* comp,
+                                                uint8_t priority,
+                                                uint32_t except) {
+  if (_batchDepth > 0) {
+    markPending(comp);
+    return;
+  }
+
+  // Nobody shows this group, so don't serialize it. Clients that subscribe
+  // later are sent the current value then.
+  uint8_t group = groupOf(comp);
+  if (!(subscribedGroups() & group)) {
+    _stats.updatesUnwatched++;
+    return;
+  }
+
+  refreshValueFragment(comp);
+
+  // Clients already know the schema, so only the id and value are sent
+  size_t length = valueLength(comp) + 40;
+  DashboardSocketBuffer* message = makeMessage(length);
+  DashboardFrame frame(_pool, length, storageOf(message));
+  frame.append("{\"type\":\"component_update\",\"component\":");
+  appendComponentValue(frame, comp);
+  frame.append('}');
+  sendToGroups(group, frame, priority, comp, except, message);
+  releaseMessage(message);
+}
+
+void WebDashboardBase::broadcastPendingComponents() {
+  if (_pendingCount == 0 && !_machineStatePending) {
+    return;
+  }
+
+  // Everything changed since the last flush goes out in one frame per
+  // distinct subscription, holding only the groups it shows. With a single
+  // subscription (the usual case) that is one frame for every client.
+  uint8_t watched = subscribedGroups();
+  uint8_t subscriptions = 0;  // Bit n set: a client subscribes to groups n
+  for (int i = 0; i < _clientCount; i++) {
+    if (_clients[i].connected) {
+      subscriptions |= 1 << _clients[i].groups;
+    }
+  }
+#if DASHBOARD_ENABLE_EVENTS
+  if (_events.count() > 0) {
+    subscriptions |= 1 << GROUP_ALL;
+  }
+#endif
+  if (hasUntrackedClients() || (subscriptions & (subscriptions - 1)) == 0) {
+    sendPendingComponents(watched, true);
+  } else {
+    for (uint8_t groups = 0; groups <= GROUP_ALL; groups++) {
+      if (subscriptions & (1 << groups)) {
+        sendPendingComponents(groups, false);
+      }
+    }
+  }
+
+  // The scans stop at the last pending component
+  for (int i = 0; i < _componentCount && _pendingCount > 0; i++) {
+    DashboardComponent* comp = component(i);
+    if (comp->pending) {
+      if (!(groupOf(comp) & watched)) {
+        _stats.updatesUnwatched++;
+      }
+      comp->pending = false;
+      _pendingCount--;
+    }
+  }
+  _machineStatePending = false;
+}
+
+// Send the pending components in the given groups, plus the machine state
+// if it changed, to the clients subscribed to exactly those groups, or to
+// every client if they all share them
+void WebDashboardBase::sendPendingComponents(uint8_t groups, bool everyone) {
+  // The scans stop at the last pending component. The length is exact, so
+  // the frame is written straight into the buffer the sockets send.
+  size_t length = 39;
+  int count = 0;
+  int pendingSeen = 0;
+  for (int i = 0; i < _componentCount && pendingSeen < _pendingCount; i++) {
+    DashboardComponent* comp = component(i);
+    if (comp->pending) {
+      pendingSeen++;
+      if (groupOf(comp) & groups) {
+        refreshValueFragment(comp);
+        length += valueLength(comp) + (count > 0 ? 1 : 0);
+        count++;
+      }
+    }
+  }
+  if (count == 0 && !_machineStatePending) {
+    return;
+  }
+
+  if (_machineStatePending) {
+    length += 16 + DashboardFrame::jsonStringLength(_machineState);
+  }
+
+  DashboardSocketBuffer* message = makeMessage(length);
+  DashboardFrame frame(_pool, length, storageOf(message));
+  frame.append("{\"type\":\"batch_update\",");
+  if (_machineStatePending) {
+    frame.append("\"machineState\":");
+    frame.appendJsonString(_machineState);
+    frame.append(',');
+  }
+
+  frame.append("\"components\":[");
+  bool first = true;
+  pendingSeen = 0;
+  for (int i = 0; i < _componentCount && pendingSeen < _pendingCount; i++) {
+    DashboardComponent* comp = component(i);
+    if (comp->pending) {
+      pendingSeen++;
+      if (groupOf(comp) & groups) {
+        if (!first) {
+          frame.append(',');
+        }
+        appendComponentValue(frame, comp);
+        first = false;
+      }
+    }
+  }
+  frame.append("]}");
+
+  if (everyone) {
+    sendFrame(ALL_CLIENTS, frame, PRIORITY_TELEMETRY, NULL, message);
+    releaseMessage(message);
+    return;
+  }
+  DashboardSocketBuffer* shared = shareFrame(frame, message);
+  for (int i = 0; i < _clientCount; i++) {
+    if (_clients[i].connected && _clients[i].groups == groups) {
+      sendFrame(_clients[i].id, frame, PRIORITY_TELEMETRY, NULL, shared);
+    }
+  }
+  releaseMessage(shared);
+  releaseMessage(message);
+#if DASHBOARD_ENABLE_EVENTS
+  // Viewers of /events show every group
+  if (groups == GROUP_ALL) {
+    _events.publish(frame.c_str(), frame.length());
+  }
+#endif
+}
+
+// A component's JSON is its cached schema fragment followed by its cached
+// value fragment, so serializing it is two appends
+void WebDashboardBase::appendComponent(DashboardFrame& out,
+                                       DashboardComponent* comp) {
+  out.append('{');
+  if (comp->schemaJson) {
+    out.append(comp->schemaJson, comp->schemaLength);
+  }
+  if (comp->valueLength > 0) {
+    out.append(',');
+    out.append(comp->valueJson, comp->valueLength);
+  }
+  out.append('}');
+}
+
+size_t WebDashboardBase::componentLength(DashboardComponent* comp) {
+  return comp->schemaLength + comp->valueLength + 3;
+}
+
+// The id is the leading member of the schema fragment, so a value entry is
+// that prefix plus the value fragment
+void WebDashboardBase::appendComponentValue(DashboardFrame& out,
+                                            DashboardComponent* comp) {
+  out.append('{');
+  out.append(comp->schemaJson, comp->idLength);
+  if (comp->valueLength > 0) {
+    out.append(',');
+    out.append(comp->valueJson, comp->valueLength);
+  }
+  out.append('}');
+}
+
+size_t WebDashboardBase::valueLength(DashboardComponent* comp) {
+  return comp->idLength + 2 +
+         (comp->valueLength > 0 ? comp->valueLength + 1 : 0);
+}
+
+void WebDashboardBase::buildSchemaFragment(DashboardComponent* comp) {
+  DashboardFrame json(_pool, 96);
+  json.append("\"id\":");
+  json.appendJsonString(comp->id);
+  size_t idLength = json.length();
+  json.append(",\"type\":");
+  json.append(static_cast<int>(comp->type));
+  json.append(",\"label\":");
+  json.appendJsonString(comp->label);
+
+  // Add component-specific configuration
+  switch (comp->type) {
+    case ComponentType::SLIDER:
+      json.append(",\"config\":{\"min\":");
+      json.append(comp->config.slider.min);
+      json.append(",\"max\":");
+      json.append(comp->config.slider.max);
+      json.append(",\"step\":");
+      json.append(comp->config.slider.step);
+      json.append('}');
+      break;
+
+    case ComponentType::SELECT:
+      json.append(",\"config\":{\"options\":[");
+      for (int j = 0; j < comp->config.select.optionCount; j++) {
+        if (j > 0) {
+          json.append(',');
+        }
+        json.appendJsonString(comp->config.select.options[j]);
+      }
+      json.append("]}");
+      break;
+
+#if DASHBOARD_ENABLE_PIN_MONITORS
+    case ComponentType::PIN_MONITOR:
+      // Pin monitors report their range for the progress bar
+      json.append(",\"min\":0,\"max\":");
+      json.append(comp->config.pinMonitor.isAnalog
+                      ? 4095
+                      : 1);  // ESP32 has 12-bit ADC (0-4095)
+      break;
+#endif
+
+    default:
+      break;
+  }
+
+  if (!comp->schemaStatic) {
+    free((void*)comp->schemaJson);
+  }
+  char* schema = json.overflowed() ? NULL : (char*)malloc(json.length() + 1);
+  comp->schemaJson = schema;
+  comp->schemaStatic = false;
+  if (schema) {
+    memcpy(schema, json.c_str(), json.length() + 1);
+    comp->schemaLength = json.length();
+    comp->idLength = idLength;
+  } else {
+    comp->schemaLength = 0;
+    comp->idLength = 0;
+  }
+  _schemaHashValid = false;
+  _revision++;
+}
+
+void WebDashboardBase::refreshValueFragment(DashboardComponent* comp) {
+  if (!comp->valueDirty) {
+    return;
+  }
+  comp->valueDirty = false;
+
+  DashboardFrame json(_pool,
+                      comp->value.capacity + DASHBOARD_FLOAT_LENGTH + 24);
+  switch (comp->value.type) {
+    case ValueType::INT:
+      json.append("\"value\":");
+      json.append(comp->value.intValue);
+      break;
+
+    case ValueType::FLOAT:
+      // Sent rounded to its precision; the client formats it
+      json.append("\"value\":");
+      json.appendFloat(comp->value.floatValue, comp->value.precision);
+      json.append(",\"precision\":");
+      json.append((int)comp->value.precision);
+      break;
+
+    case ValueType::BOOL:
+      json.append(comp->value.boolValue ? "\"value\":true" : "\"value\":false");
+      break;
+
+    case ValueType::STRING:
+      json.append("\"value\":");
+      json.appendJsonString(comp->value.text ? comp->value.text : "");
+      break;
+
+    default:
+      break;
+  }
+
+  // Reuse the fragment buffer unless the new value doesn't fit
+  size_t length = json.length();
+  if (json.overflowed()) {
+    comp->valueLength = 0;
+    return;
+  }
+  if (length + 1 > comp->valueCapacity) {
+    char* buffer = (char*)realloc(comp->valueJson, length + 1);
+    if (!buffer) {
+      comp->valueLength = 0;
+      return;
+    }
+    comp->valueJson = buffer;
+    comp->valueCapacity = length + 1;
+  }
+  memcpy(comp->valueJson, json.c_str(), length + 1);
+  comp->valueLength = length;
+}
+
+void WebDashboardBase::sampleBindings() {
+  // Changed bindings are collected into a single batch frame
+  beginBatch();
+  int bindingsSeen = 0;
+  for (int i = 0; i < _componentCount && bindingsSeen < _bindingCount; i++) {
+    DashboardComponent* comp = component(i);
+    if (comp->active && comp->binding.type != BindingType::NONE) {
+      bindingsSeen++;
+      if (sampleBinding(comp)) {
+        broadcastComponentUpdate(comp);
+      }
+    }
+  }
+  commit();
+}
+
+bool WebDashboardBase::sampleBinding(DashboardComponent* comp) {
+  int intValue = 0;
+  float floatValue = 0;
+  bool boolValue = false;
+
+  // Take the writer's lock only for the read itself, so a snapshot is
+  // consistent even when the variable is written from another task
+  if (comp->binding.lock) {
+    portENTER_CRITICAL(comp->binding.lock);
+  }
+  switch (comp->binding.type) {
+    case BindingType::INT:
+      intValue = *comp->binding.source.intValue;
+      break;
+    case BindingType::FLOAT:
+      floatValue = *comp->binding.source.floatValue;
+      break;
+    case BindingType::BOOL:
+      boolValue = *comp->binding.source.boolValue;
+      break;
+    default:
+      break;
+  }
+  if (comp->binding.lock) {
+    portEXIT_CRITICAL(comp->binding.lock);
+  }
+
+  // Getters run outside the critical section
+  switch (comp->binding.type) {
+    case BindingType::INT_GETTER:
+      intValue = comp->binding.source.intGetter();
+      break;
+    case BindingType::FLOAT_GETTER:
+      floatValue = comp->binding.source.floatGetter();
+      break;
+    case BindingType::BOOL_GETTER:
+      boolValue = comp->binding.source.boolGetter();
+      break;
+    default:
+      break;
+  }
+
+  // storeValue() does the change detection
+  switch (comp->binding.type) {
+    case BindingType::INT:
+    case BindingType::INT_GETTER:
+      return storeValue(comp, intValue);
+    case BindingType::FLOAT:
+    case BindingType::FLOAT_GETTER:
+      return storeValue(comp, floatValue, comp->binding.precision);
+    case BindingType::BOOL:
+    case BindingType::BOOL_GETTER:
+      return storeValue(comp, boolValue);
+    default:
+      return false;
+  }
+}
+
+bool WebDashboardBase::attachBinding(const char* id, BindingType type,
+                                     int precision, portMUX_TYPE* lock,
+                                     DashboardComponent** out) {
+  DashboardComponent* comp = findComponent(id);
+  if (!comp || comp->type == ComponentType::BUTTON) {
+    return false;
+  }
+
+  if (comp->binding.type == BindingType::NONE) {
+    _bindingCount++;
+  }
+
+  comp->binding.type = type;
+  comp->binding.precision = precision;
+  comp->binding.lock = lock;
+  *out = comp;
+  return true;
+}
+
+WebDashboardBase::DashboardComponent* WebDashboardBase::createComponent(
+    const char* id, const char* label, ComponentType type, void* callback) {
+  // Reuse the most recently removed slot before taking a new one
+  int index = _freeList >= 0 ? _freeList : _componentCount;
+  if (index == _componentCount && _componentCount >= _maxComponents) {
+    return NULL;
+  }
+  if (index >= _componentCapacity +
+                   _segmentCount * DASHBOARD_COMPONENT_SEGMENT_SIZE &&
+      !growComponents()) {
+    if (_debugLoggingEnabled) {
+      Serial.printf("Out of memory, cannot add component %s\n", id);
+    }
+    return NULL;
+  }
+
+  const char* storedId = _strings.intern(id, MAX_COMPONENT_ID_LENGTH);
+  const char* storedLabel = _strings.intern(label, MAX_COMPONENT_LABEL_LENGTH);
+  if (!storedId || !storedLabel) {
+    if (_debugLoggingEnabled) {
+      Serial.printf("String arena full, cannot add component %s\n", id);
+    }
+    return NULL;
+  }
+
+  DashboardComponent* comp = component(index);
+  if (index == _freeList) {
+    _freeList = comp->config.nextFree;
+    _freeCount--;
+  } else {
+    _componentCount++;
+  }
+
+  // Bump the slot generation so handles to a previous occupant go stale
+  uint16_t generation = comp->generation + 1;
+  memset(comp, 0, sizeof(DashboardComponent));
+  comp->generation = generation;
+  comp->id = storedId;
+  comp->label = storedLabel;
+  comp->type = type;
+  comp->active = true;
+  comp->callback = callback;
+  comp->valueDirty = true;
+  indexComponent(index);
+  return comp;
+}
+
+bool WebDashboardBase::deleteComponent(DashboardComponent* comp) {
+  if (!comp) {
+    return false;
+  }
+
+  // Ids live in the arena or in flash, so this outlives the slot
+  const char* id = comp->id;
+  releaseComponent(comp);
+  broadcastComponentRemoved(id);
+  return true;
+}
+
+// Free everything a component holds and put its slot on the free list.
+// Its strings stay in the arena, where a re-added id finds them again.
+void WebDashboardBase::releaseComponent(DashboardComponent* comp) {
+  int index = indexOf(comp);
+  unindexComponent(index);
+
+  if (comp->pending) {
+    _pendingCount--;
+  }
+  if (comp->binding.type != BindingType::NONE) {
+    _bindingCount--;
+  }
+#if DASHBOARD_ENABLE_PIN_MONITORS
+  if (comp->type == ComponentType::PIN_MONITOR) {
+    _pinMonitorCount--;
+  }
+#endif
+  if (!comp->schemaStatic) {
+    free((void*)comp->schemaJson);
+  }
+  free(comp->valueJson);
+  free(comp->value.text);
+
+  uint16_t generation = comp->generation;
+  memset(comp, 0, sizeof(DashboardComponent));
+  comp->generation = generation;
+  comp->config.nextFree = _freeList;
+  _freeList = index;
+  _freeCount++;
+  _schemaHashValid = false;
+  _revision++;
+}
+
+WebDashboardBase::DashboardComponent* WebDashboardBase::findComponent(
+    const char* id) {
+  if (!id) {
+    return NULL;
+  }
+
+  if (!_idIndex) {
+    for (int i = 0; i < _componentCount; i++) {
+      DashboardComponent* comp = component(i);
+      if (comp->active && strcmp(comp->id, id) == 0) {
+        return comp;
+      }
+    }
+    return NULL;
+  }
+
+  int mask = _idIndexSize - 1;
+  for (int i = hashId(id) & mask; _idIndex[i]; i = (i + 1) & mask) {
+    DashboardComponent* comp = component(_idIndex[i] - 1);
+    if (comp->active && strcmp(comp->id, id) == 0) {
+      return comp;
+    }
+  }
+  return NULL;
+}
+
+WebDashboardBase::WebClient* WebDashboardBase::findClient(uint32_t clientId) {
+  for (int i = 0; i < _clientCount; i++) {
+    if (_clients[i].id == clientId) {
+      return &_clients[i];
+    }
+  }
+  return NULL;
+}
+
+// Add a segment of slots past the built-in storage. Segments are never
+// moved or freed, so component pointers and handles stay valid.
+bool WebDashboardBase::growComponents() {
+  static_assert((DASHBOARD_COMPONENT_SEGMENT_SIZE &
+                 (DASHBOARD_COMPONENT_SEGMENT_SIZE - 1)) == 0,
+                "DASHBOARD_COMPONENT_SEGMENT_SIZE must be a power of two");
+
+  DashboardComponent** segments = (DashboardComponent**)realloc(
+      _segments, (_segmentCount + 1) * sizeof(DashboardComponent*));
+  if (!segments) {
+    return false;
+  }
+  _segments = segments;
+
+  // Large dashboards only fit in PSRAM; use it where the board has some
+  size_t size = DASHBOARD_COMPONENT_SEGMENT_SIZE * sizeof(DashboardComponent);
+  DashboardComponent* segment = (DashboardComponent*)heap_caps_malloc_prefer(
+      size, 2, MALLOC_CAP_SPIRAM, MALLOC_CAP_8BIT);
+  if (!segment) {
+    return false;
+  }
+  memset(segment, 0, size);
+  _segments[_segmentCount++] = segment;
+  return true;
+}
+
+int WebDashboardBase::indexOf(DashboardComponent* comp) {
+  if (comp >= _components && comp < _components + _componentCapacity) {
+    return comp - _components;
+  }
+  for (int i = 0; i < _segmentCount; i++) {
+    if (comp >= _segments[i] &&
+        comp < _segments[i] + DASHBOARD_COMPONENT_SEGMENT_SIZE) {
+      return _componentCapacity + i * DASHBOARD_COMPONENT_SEGMENT_SIZE +
+             (comp - _segments[i]);
+    }
+  }
+  return -1;
+}
+
+// FNV-1a, the same hash the schema uses
+uint32_t WebDashboardBase::hashId(const char* id) {
+  uint32_t hash = 2166136261u;
+  for (; *id; id++) {
+    hash = (hash ^ (uint8_t)*id) * 16777619u;
+  }
+  return hash;
+}
+
+// Add a slot to the id index, growing the table to keep it at most half
+// full. Without memory for the table, lookups fall back to a linear scan.
+void WebDashboardBase::indexComponent(int index) {
+  if ((_idIndexCount + 1) * 2 > _idIndexSize) {
+    int size = 16;
+    while (size < _componentCount * 2) {
+      size *= 2;
+    }
+    // Rebuilding adds every active slot, this one included
+    if (!rebuildIdIndex(size) && _debugLoggingEnabled) {
+      Serial.println("Out of memory for the id index, using linear lookup");
+    }
+    return;
+  }
+
+  int mask = _idIndexSize - 1;
+  int i = hashId(component(index)->id) & mask;
+  while (_idIndex[i]) {
+    i = (i + 1) & mask;
+  }
+  _idIndex[i] = index + 1;
+  _idIndexCount++;
+}
+
+// Remove a slot from the id index, moving later entries of the probe chain
+// back so lookups never stop at the hole
+void WebDashboardBase::unindexComponent(int index) {
+  if (!_idIndex) {
+    return;
+  }
+
+  int mask = _idIndexSize - 1;
+  int hole = hashId(component(index)->id) & mask;
+  while (_idIndex[hole] && _idIndex[hole] != index + 1) {
+    hole = (hole + 1) & mask;
+  }
+  if (!_idIndex[hole]) {
+    return;
+  }
+
+  for (int i = (hole + 1) & mask; _idIndex[i]; i = (i + 1) & mask) {
+    int home = hashId(component(_idIndex[i] - 1)->id) & mask;
+    // An entry can fill the hole if its home slot isn't between the hole
+    // and its current position
+    bool movable = hole <= i ? (home <= hole || home > i)
+                             : (home <= hole && home > i);
+    if (movable) {
+      _idIndex[hole] = _idIndex[i];
+      hole = i;
+    }
+  }
+  _idIndex[hole] = 0;
+  _idIndexCount--;
+}
+
+bool WebDashboardBase::rebuildIdIndex(int size) {
+  free(_idIndex);
+  _idIndex = (uint16_t*)calloc(size, sizeof(uint16_t));
+  _idIndexCount = 0;
+  if (!_idIndex) {
+    _idIndexSize = 0;
+    return false;
+  }
+  _idIndexSize = size;
+
+  int mask = size - 1;
+  for (int index = 0; index < _componentCount; index++) {
+    DashboardComponent* comp = component(index);
+    if (!comp->active) {
+      continue;
+    }
+    int i = hashId(comp->id) & mask;
+    while (_idIndex[i]) {
+      i = (i + 1) & mask;
+    }
+    _idIndex[i] = index + 1;
+    _idIndexCount++;
+  }
+  return true;
+}
+
+void WebDashboardBase::markPending(DashboardComponent* comp) {
+  if (!comp->pending) {
+    comp->pending = true;
+    _pendingCount++;
+  }
 }
 
-void WebDashboard::cleanupOldLogs() {
+#if DASHBOARD_ENABLE_LOGGING
+void WebDashboardBase::cleanupOldLogs() {
   uint32_t now = millis();
 
   // Check for rollover
@@ -830,7 +3409,8 @@ void WebDashboard::cleanupOldLogs() {
     }
   }
 }
+#endif
 
-void WebDashboard::handleNotFound(AsyncWebServerRequest* request) {
+void WebDashboardBase::handleNotFound(AsyncWebServerRequest* request) {
   request->send(404, "text/plain", "404: Not Found");
 }
\ No newline at end of file
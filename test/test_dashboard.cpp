@@ -1,11 +1,14 @@
 #include <Arduino.h>
 #include <WebDashboard.h>
+#include <float.h>
 #include <unity.h>
 
 WebDashboard dashboard;
 bool buttonPressed = false;
 bool toggleState = false;
 int sliderValue = 0;
+int boundCounter = 0;
+float boundLevel = 0.0;
 
 // Test callback functions
 void testButtonCallback(const char* id) {
@@ -59,6 +62,88 @@ void test_update_values() {
   TEST_ASSERT_TRUE(boolResult);
 }
 
+void test_handle_updates() {
+  SliderHandle slider =
+      dashboard.addSlider("handle_slider", "Handle Slider", 0, 10, 5);
+  TextInputHandle text =
+      dashboard.addTextInput("handle_text", "Handle Text", "");
+  TEST_ASSERT_TRUE(slider.isValid());
+  TEST_ASSERT_TRUE(text.isValid());
+
+  TEST_ASSERT_TRUE(dashboard.updateValue(slider, 7));
+  TEST_ASSERT_TRUE(dashboard.updateValue(text, "hello"));
+  TEST_ASSERT_TRUE(dashboard.updateValue(text, 12.5f, 1));
+
+  // A default-constructed handle refers to nothing
+  SliderHandle empty;
+  TEST_ASSERT_FALSE(empty.isValid());
+  TEST_ASSERT_FALSE(dashboard.updateValue(empty, 1));
+}
+
+void test_bind_values() {
+  TEST_ASSERT_TRUE(dashboard.bindValue("test_slider", &boundCounter));
+  TEST_ASSERT_TRUE(dashboard.bindValue("test_toggle", &toggleState));
+  TEST_ASSERT_FALSE(dashboard.bindValue("missing", &boundLevel, 1));
+
+  // Buttons carry no value and cannot be bound
+  TEST_ASSERT_FALSE(dashboard.bindValue("test_button", &boundCounter));
+
+  boundCounter = 42;
+  dashboard.update();
+
+  TEST_ASSERT_TRUE(dashboard.unbindValue("test_slider"));
+  TEST_ASSERT_FALSE(dashboard.unbindValue("test_slider"));
+  TEST_ASSERT_TRUE(dashboard.unbindValue("test_toggle"));
+}
+
+void test_skip_unchanged() {
+  dashboard.updateValue("test_slider", 30);
+  dashboard.resetStats();
+
+  // Identical values are suppressed
+  TEST_ASSERT_TRUE(dashboard.updateValue("test_slider", 30));
+  TEST_ASSERT_EQUAL_UINT32(1, dashboard.getStats().updatesSuppressed);
+  TEST_ASSERT_EQUAL_UINT32(0, dashboard.getStats().updatesSent);
+
+  TEST_ASSERT_TRUE(dashboard.updateValue("test_slider", 31));
+  TEST_ASSERT_EQUAL_UINT32(1, dashboard.getStats().updatesSent);
+
+  // Floats compare at their display precision
+  dashboard.updateValue("handle_text", 20.0f, 1);
+  dashboard.resetStats();
+  dashboard.updateValue("handle_text", 20.02f, 1);
+  TEST_ASSERT_EQUAL_UINT32(1, dashboard.getStats().updatesSuppressed);
+  dashboard.updateValue("handle_text", 20.1f, 1);
+  TEST_ASSERT_EQUAL_UINT32(1, dashboard.getStats().updatesSent);
+
+  // 20.04 shows as 20.0 and 20.08 as 20.1, though they are closer than 0.05
+  dashboard.updateValue("handle_text", 20.04f, 1);
+  dashboard.resetStats();
+  dashboard.updateValue("handle_text", 20.08f, 1);
+  TEST_ASSERT_EQUAL_UINT32(1, dashboard.getStats().updatesSent);
+
+  // Strings compare as stored, so an over-long one sent again is suppressed
+  char text[MAX_VALUE_LENGTH + 8];
+  memset(text, 'x', sizeof(text) - 1);
+  text[sizeof(text) - 1] = 0;
+  dashboard.updateValue("handle_text", text);
+  dashboard.resetStats();
+  dashboard.updateValue("handle_text", text);
+  TEST_ASSERT_EQUAL_UINT32(1, dashboard.getStats().updatesSuppressed);
+}
+
+void test_unwatched_updates() {
+  // No browser is subscribed to any group, so updates aren't serialized
+  dashboard.resetStats();
+  dashboard.updateValue("test_slider", 40);
+  dashboard.updateValue("test_slider", 41);
+
+  const DashboardStats& stats = dashboard.getStats();
+  TEST_ASSERT_EQUAL_UINT32(2, stats.updatesSent);
+  TEST_ASSERT_EQUAL_UINT32(2, stats.updatesUnwatched);
+  TEST_ASSERT_EQUAL_UINT32(0, stats.poolAllocations);
+}
+
 void test_logging() {
   bool infoLogResult = dashboard.log("Info log message", LOG_INFO);
   TEST_ASSERT_TRUE(infoLogResult);
@@ -73,6 +158,416 @@ void test_logging() {
   TEST_ASSERT_TRUE(formatLogResult);
 }
 
+void test_message_priorities() {
+  // With the sockets idle, frames skip the queues but count for their class
+  dashboard.resetStats();
+  dashboard.log("Error log message", LOG_ERROR);
+  dashboard.log("Info log message", LOG_INFO);
+
+  const DashboardStats& stats = dashboard.getStats();
+  TEST_ASSERT_EQUAL_UINT32(1, stats.queues[PRIORITY_CRITICAL].sent);
+  TEST_ASSERT_EQUAL_UINT32(1, stats.queues[PRIORITY_TELEMETRY].sent);
+  for (int c = 0; c < PRIORITY_COUNT; c++) {
+    TEST_ASSERT_EQUAL_UINT16(0, stats.queues[c].depth);
+    TEST_ASSERT_EQUAL_UINT32(0, stats.queues[c].dropped);
+  }
+}
+
+void test_message_parser() {
+  char frame[] =
+      "{\"type\":\"text_input_change\",\"id\":\"test_text\","
+      "\"value\":\"a\\\"b\\u00e9\",\"extra\":[1,{\"x\":2}]}";
+  DashboardMessage msg;
+  TEST_ASSERT_TRUE(msg.parse(frame, strlen(frame)));
+  TEST_ASSERT_TRUE(msg.type == DashboardMessageType::TEXT_INPUT_CHANGE);
+  TEST_ASSERT_EQUAL_STRING("test_text", msg.id);
+  TEST_ASSERT_EQUAL_STRING("a\"b\xc3\xa9", msg.text);
+
+  // The length bounds the parse; the frame needn't be NUL-terminated
+  char slider[] = "{\"type\":\"slider_change\",\"value\":-7}garbage";
+  TEST_ASSERT_TRUE(msg.parse(slider, strlen(slider) - 7));
+  TEST_ASSERT_TRUE(msg.type == DashboardMessageType::SLIDER_CHANGE);
+  TEST_ASSERT_EQUAL_INT(-7, msg.number);
+  TEST_ASSERT_NULL(msg.id);
+
+  char unknown[] = "{\"type\":\"reboot\"}";
+  TEST_ASSERT_TRUE(msg.parse(unknown, strlen(unknown)));
+  TEST_ASSERT_TRUE(msg.type == DashboardMessageType::UNKNOWN);
+
+  char truncated[] = "{\"type\":\"slider_change\",\"value\":";
+  TEST_ASSERT_FALSE(msg.parse(truncated, strlen(truncated)));
+
+  // Nothing after the colon: the parser must stop at the end of the frame
+  char colon[] = "{\"type\":";
+  TEST_ASSERT_FALSE(msg.parse(colon, strlen(colon)));
+}
+
+void test_rpc_calls() {
+  // The method is the message type, and params name the component
+  char call[] =
+      "{\"jsonrpc\":\"2.0\",\"id\":7,\"method\":\"slider_change\","
+      "\"params\":{\"id\":\"test_slider\",\"value\":40}}";
+  DashboardMessage msg;
+  TEST_ASSERT_TRUE(msg.parse(call, strlen(call)));
+  TEST_ASSERT_TRUE(msg.rpc);
+  TEST_ASSERT_TRUE(msg.type == DashboardMessageType::SLIDER_CHANGE);
+  TEST_ASSERT_TRUE(msg.hasRequestId);
+  TEST_ASSERT_EQUAL_INT(7, msg.requestNumber);
+  TEST_ASSERT_EQUAL_STRING("test_slider", msg.id);
+  TEST_ASSERT_EQUAL_INT(40, msg.number);
+
+  // A batch is parsed one call at a time; a call without an id is a
+  // notification
+  char batch[] =
+      "[{\"jsonrpc\":\"2.0\",\"id\":\"a\",\"method\":\"get_value\","
+      "\"params\":{\"id\":\"x\"}},"
+      "{\"jsonrpc\":\"2.0\",\"method\":\"button_press\","
+      "\"params\":{\"id\":\"y\"}}]";
+  char* cursor = batch;
+  char* end = batch + strlen(batch);
+  TEST_ASSERT_TRUE(msg.parseNext(&cursor, end));
+  TEST_ASSERT_TRUE(msg.type == DashboardMessageType::GET_VALUE);
+  TEST_ASSERT_EQUAL_STRING("a", msg.requestId);
+  TEST_ASSERT_TRUE(msg.parseNext(&cursor, end));
+  TEST_ASSERT_FALSE(msg.hasRequestId);
+  TEST_ASSERT_EQUAL_STRING("y", msg.id);
+  TEST_ASSERT_FALSE(msg.parseNext(&cursor, end));
+  TEST_ASSERT_NOT_NULL(cursor);
+
+  char broken[] = "[{\"id\":1},";
+  cursor = broken;
+  end = broken + strlen(broken);
+  TEST_ASSERT_TRUE(msg.parseNext(&cursor, end));
+  TEST_ASSERT_FALSE(msg.parseNext(&cursor, end));
+  TEST_ASSERT_NULL(cursor);
+
+  // Elements that aren't objects are each an invalid request, and a null
+  // id is answered rather than taken for a notification
+  char mixed[] =
+      "[1,{\"jsonrpc\":\"2.0\",\"id\":null,\"method\":\"get_value\"}]";
+  cursor = mixed;
+  end = mixed + strlen(mixed);
+  TEST_ASSERT_TRUE(msg.parseNext(&cursor, end));
+  TEST_ASSERT_FALSE(msg.rpc);
+  TEST_ASSERT_TRUE(msg.parseNext(&cursor, end));
+  TEST_ASSERT_TRUE(msg.rpc);
+  TEST_ASSERT_TRUE(msg.hasRequestId);
+  TEST_ASSERT_TRUE(msg.requestNull);
+  TEST_ASSERT_FALSE(msg.parseNext(&cursor, end));
+  TEST_ASSERT_NOT_NULL(cursor);
+}
+
+void test_event_stream() {
+  DashboardPool pool;
+  DashboardEvents events(pool);
+  uint32_t first = events.open();
+  uint32_t second = events.open();
+  TEST_ASSERT_NOT_EQUAL(0, first);
+
+  // The loop task learns of each new viewer once
+  TEST_ASSERT_EQUAL_UINT32(first, events.accept());
+  TEST_ASSERT_EQUAL_UINT32(second, events.accept());
+  TEST_ASSERT_EQUAL_UINT32(0, events.accept());
+  events.stream(first);
+  events.stream(second);
+
+  // One frame, shared by both viewers
+  events.publish("{\"a\":1}", 7);
+  char buffer[64];
+  for (uint32_t id : {first, second}) {
+    size_t length = events.fill(id, (uint8_t*)buffer, sizeof(buffer) - 1);
+    buffer[length] = '\0';
+    TEST_ASSERT_EQUAL_STRING("retry: 2000\n\ndata: {\"a\":1}\n\n", buffer);
+    TEST_ASSERT_EQUAL(RESPONSE_TRY_AGAIN,
+                      events.fill(id, (uint8_t*)buffer, sizeof(buffer)));
+  }
+
+  DashboardEventStats stats;
+  events.getStats(&stats);
+  TEST_ASSERT_EQUAL_UINT32(1, stats.published);
+  TEST_ASSERT_EQUAL_UINT32(2, stats.delivered);
+  TEST_ASSERT_EQUAL_UINT32(1, stats.copiesSaved);
+  TEST_ASSERT_EQUAL_UINT16(0, pool.getStats().inUse);
+
+  // A viewer still paging holds nothing in the ring, so it isn't dropped
+  // however much is published, and streams from where it starts
+  uint32_t paging = events.open();
+  for (int i = 0; i < DASHBOARD_EVENT_RING + 2; i++) {
+    events.publish("{}", 2);
+  }
+  TEST_ASSERT_TRUE(events.connected(paging));
+  events.stream(paging);
+  events.publish("{\"b\":2}", 7);
+  size_t length = events.fill(paging, (uint8_t*)buffer, sizeof(buffer) - 1);
+  buffer[length] = '\0';
+  TEST_ASSERT_EQUAL_STRING("retry: 2000\n\ndata: {\"b\":2}\n\n", buffer);
+
+  // A closed viewer's id is never reused
+  events.close(first);
+  TEST_ASSERT_FALSE(events.connected(first));
+  TEST_ASSERT_NOT_EQUAL(first, events.open());
+}
+
+void test_batch_updates() {
+  TEST_ASSERT_FALSE(dashboard.commit());
+
+  dashboard.beginBatch();
+  TEST_ASSERT_TRUE(dashboard.isBatching());
+  dashboard.setMachineState("BATCHED");
+  TEST_ASSERT_TRUE(dashboard.updateValue("test_slider", 10));
+  TEST_ASSERT_TRUE(dashboard.updateValue("test_toggle", false));
+
+  // State is applied immediately, only the broadcast is deferred
+  TEST_ASSERT_EQUAL_STRING("BATCHED", dashboard.getMachineState());
+  TEST_ASSERT_TRUE(dashboard.commit());
+  TEST_ASSERT_FALSE(dashboard.isBatching());
+
+  {
+    DashboardBatch batch(dashboard);
+    TEST_ASSERT_TRUE(dashboard.isBatching());
+    dashboard.updateValue("test_slider", 20);
+  }
+  TEST_ASSERT_FALSE(dashboard.isBatching());
+}
+
+void test_frame_pool() {
+  dashboard.resetStats();
+  for (int i = 0; i < 20; i++) {
+    dashboard.updateValue("test_slider", i);
+    dashboard.logf(LOG_INFO, "Pool message %d", i);
+  }
+
+  // Frames are written into socket buffers or served by the pool, and every
+  // pool buffer is returned after use
+  const DashboardStats& stats = dashboard.getStats();
+  TEST_ASSERT_TRUE(stats.socketFrames + stats.poolAllocations > 0);
+  TEST_ASSERT_EQUAL_UINT32(0, stats.poolFallbacks);
+  TEST_ASSERT_EQUAL_UINT16(0, stats.poolInUse);
+  TEST_ASSERT_TRUE(stats.freeHeap > 0);
+}
+
+void test_shared_frames() {
+  // A frame written into caller storage never grows past it
+  DashboardPool pool;
+  char storage[16];
+  DashboardFrame fixed(pool, sizeof(storage) - 1, storage);
+  fixed.append("{\"a\":");
+  fixed.appendJsonString("b\n");
+  fixed.append('}');
+  TEST_ASSERT_EQUAL_STRING("{\"a\":\"b\\n\"}", storage);
+  TEST_ASSERT_EQUAL(5, DashboardFrame::jsonStringLength("b\n"));
+  TEST_ASSERT_FALSE(fixed.overflowed());
+  fixed.append("too long to fit");
+  TEST_ASSERT_TRUE(fixed.overflowed());
+  TEST_ASSERT_EQUAL_UINT32(0, pool.getStats().allocations);
+
+  // The largest floats are written in full, and their fragments agree
+  // with the exact frame lengths
+  DashboardFrame number(pool, DASHBOARD_FLOAT_LENGTH);
+  number.appendFloat(-FLT_MAX, 6);
+  TEST_ASSERT_EQUAL(DASHBOARD_FLOAT_LENGTH, number.length());
+  TEST_ASSERT_EQUAL_STRING(".000000",
+                           number.c_str() + DASHBOARD_FLOAT_LENGTH - 7);
+  TEST_ASSERT_TRUE(dashboard.updateValue("handle_text", FLT_MAX, 6));
+  TEST_ASSERT_TRUE(dashboard.updateValue("handle_text", -FLT_MAX, 6));
+
+  // Broadcasts are sized exactly and written straight into the buffer the
+  // sockets send, so nothing is copied after serializing
+  dashboard.resetStats();
+  dashboard.setMachineState("SHARED \"quoted\"");
+  dashboard.log("Shared\tframe", LOG_WARNING);
+  const DashboardStats& stats = dashboard.getStats();
+  TEST_ASSERT_EQUAL_UINT32(2, stats.socketFrames);
+  TEST_ASSERT_EQUAL_UINT32(0, stats.socketBytesCopied);
+}
+
+void test_socket_buffers() {
+  // A queued frame keeps its buffer while other frames are broadcast, which
+  // makes the socket library free the buffers it considers unused
+  DashboardQueue queue;
+  AsyncWebSocket socket("/buffers");
+  DashboardSocketBuffer* queued = queue.makeBuffer(5);
+  TEST_ASSERT_NOT_NULL(queued);
+  memcpy(queued->get(), "first", 5);
+  bool overflow;
+  TEST_ASSERT_TRUE(queue.push(PRIORITY_CONTROL, 1, queued, NULL, &overflow));
+  queue.releaseBuffer(queued);
+
+  DashboardSocketBuffer* broadcast = queue.makeBuffer(6);
+  memcpy(broadcast->get(), "second", 6);
+  socket.textAll(broadcast);
+  queue.releaseBuffer(broadcast);
+
+  DashboardQueuedFrame frame;
+  TEST_ASSERT_TRUE(queue.pop(&frame));
+  TEST_ASSERT_EQUAL_INT(0, memcmp("first", frame.message->get(), 5));
+  queue.release(&frame);
+
+  // Freed once nobody holds them and no socket is sending them
+  TEST_ASSERT_EQUAL_INT(2, queue.buffers());
+  queue.collect();
+  TEST_ASSERT_EQUAL_INT(0, queue.buffers());
+}
+
+void test_memory_usage() {
+  const char* options[] = {"Low", "Medium", "High"};
+  SelectHandle first =
+      dashboard.addSelect("mem_select_1", "Speed", options, 3, "Low");
+  uint32_t stringBytes = dashboard.getStats().stringBytes;
+  SelectHandle second =
+      dashboard.addSelect("mem_select_2", "Speed", options, 3, "High");
+  TEST_ASSERT_TRUE(first.isValid());
+  TEST_ASSERT_TRUE(second.isValid());
+
+  // Repeated labels and options are stored once; only the option list and
+  // the new id take arena space
+  const DashboardStats& stats = dashboard.getStats();
+  TEST_ASSERT_TRUE(stats.stringBytes - stringBytes <
+                   strlen("mem_select_2") + 1 + 4 * sizeof(const char*));
+  TEST_ASSERT_EQUAL_UINT32(
+      MAX_DASHBOARD_COMPONENTS * sizeof(WebDashboard::DashboardComponent),
+      stats.componentBytes);
+  TEST_ASSERT_TRUE(stats.fragmentBytes > 0);
+}
+
+void test_custom_capacity() {
+  // Storage is sized by the template arguments
+  BasicWebDashboard<2, 1, 4, 32> small;
+  TEST_ASSERT_TRUE(small.addButton("a", "A", NULL).isValid());
+  TEST_ASSERT_TRUE(small.addButton("b", "B", NULL).isValid());
+  TEST_ASSERT_FALSE(small.addButton("c", "C", NULL).isValid());
+  TEST_ASSERT_EQUAL_UINT32(2 * sizeof(WebDashboard::DashboardComponent),
+                           small.getStats().componentBytes);
+  TEST_ASSERT_TRUE(sizeof(small) < sizeof(WebDashboard));
+}
+
+void test_component_growth() {
+  // Grows past the built-in slots in heap segments, up to the set limit
+  BasicWebDashboard<4, 1, 4, 32> growing;
+  TEST_ASSERT_TRUE(growing.setMaxComponents(300));
+
+  char id[16];
+  TextInputHandle first;
+  TextInputHandle last;
+  for (int i = 0; i < 300; i++) {
+    snprintf(id, sizeof(id), "sensor%d", i);
+    TextInputHandle handle = growing.addTextInput(id, "Sensor", "0");
+    TEST_ASSERT_TRUE(handle.isValid());
+    if (i == 0) {
+      first = handle;
+    }
+    last = handle;
+  }
+  snprintf(id, sizeof(id), "sensor%d", 300);
+  TEST_ASSERT_FALSE(growing.addTextInput(id, "Sensor", "0").isValid());
+  TEST_ASSERT_EQUAL_INT(300, growing.getComponentCount());
+
+  // Ids resolve through the index, handles through the segments
+  TEST_ASSERT_TRUE(growing.updateValue("sensor0", 1));
+  TEST_ASSERT_TRUE(growing.updateValue("sensor150", 2));
+  TEST_ASSERT_TRUE(growing.updateValue("sensor299", 3));
+  TEST_ASSERT_FALSE(growing.updateValue("sensor300", 4));
+  TEST_ASSERT_TRUE(growing.updateValue(first, 5));
+  TEST_ASSERT_TRUE(growing.updateValue(last, 6));
+
+  const DashboardStats& stats = growing.getStats();
+  int segments = (296 + DASHBOARD_COMPONENT_SEGMENT_SIZE - 1) /
+                 DASHBOARD_COMPONENT_SEGMENT_SIZE;
+  TEST_ASSERT_EQUAL_UINT32(
+      (4 + segments * DASHBOARD_COMPONENT_SEGMENT_SIZE) *
+              sizeof(WebDashboard::DashboardComponent) +
+          segments * sizeof(void*),
+      stats.componentBytes);
+  TEST_ASSERT_TRUE(stats.indexBytes >= 600 * sizeof(uint16_t));
+}
+
+void test_remove_component() {
+  BasicWebDashboard<3, 1, 4, 32> small;
+  SliderHandle slider = small.addSlider("remove_slider", "Slider", 0, 10, 5);
+  TextInputHandle text = small.addTextInput("remove_text", "Text", "a");
+  TEST_ASSERT_TRUE(small.bindValue("remove_text", &boundCounter));
+  TEST_ASSERT_TRUE(small.addToggle("remove_toggle", "Toggle", false, NULL));
+
+  // Removal invalidates the id and handles to the component
+  TEST_ASSERT_TRUE(small.removeComponent("remove_text"));
+  TEST_ASSERT_FALSE(small.removeComponent("remove_text"));
+  TEST_ASSERT_FALSE(small.updateValue("remove_text", 1));
+  TEST_ASSERT_FALSE(small.updateValue(text, 1));
+  TEST_ASSERT_TRUE(small.removeComponent(slider));
+  TEST_ASSERT_FALSE(small.removeComponent(slider));
+  TEST_ASSERT_EQUAL_INT(1, small.getComponentCount());
+
+  // The freed slots are reused, so a full dashboard accepts two more
+  TextInputHandle again = small.addTextInput("remove_text", "Text", "b");
+  TEST_ASSERT_TRUE(again.isValid());
+  TEST_ASSERT_TRUE(small.addButton("remove_button", "Button", NULL));
+  TEST_ASSERT_FALSE(small.addButton("remove_extra", "Extra", NULL));
+  TEST_ASSERT_EQUAL_INT(3, small.getComponentCount());
+  TEST_ASSERT_FALSE(small.updateValue(text, 2));
+  TEST_ASSERT_TRUE(small.updateValue(again, 2));
+  TEST_ASSERT_TRUE(small.updateValue("remove_toggle", true));
+}
+
+static const DashboardComponentDef testLayout[] = {
+    DASHBOARD_BUTTON("layout_reset", "Reset", NULL),
+    DASHBOARD_TOGGLE("layout_pump", "Pump", true, NULL),
+    DASHBOARD_SLIDER("layout_speed", "Speed", 0, 100, 50, 5, NULL),
+    DASHBOARD_SELECT("layout_mode", "Mode", "Auto", NULL, "Auto", "Off"),
+};
+
+void test_layout() {
+  // Schema fragments are assembled at compile time
+  TEST_ASSERT_EQUAL_STRING(
+      "\"id\":\"layout_speed\",\"type\":3,\"label\":\"Speed\","
+      "\"config\":{\"min\":0,\"max\":100,\"step\":5}",
+      testLayout[2].schema);
+  TEST_ASSERT_EQUAL_STRING(
+      "\"id\":\"layout_mode\",\"type\":5,\"label\":\"Mode\","
+      "\"config\":{\"options\":[\"Auto\",\"Off\"]}",
+      testLayout[3].schema);
+  TEST_ASSERT_EQUAL_UINT16(strlen(testLayout[2].schema),
+                           testLayout[2].schemaLength);
+
+  BasicWebDashboard<4, 1, 4, 32> layoutDashboard;
+  TEST_ASSERT_TRUE(layoutDashboard.addLayout(testLayout));
+  TEST_ASSERT_TRUE(layoutDashboard.updateValue("layout_speed", 75));
+  TEST_ASSERT_TRUE(layoutDashboard.updateValue("layout_mode", "Off"));
+
+  // The dashboard is full, so a second copy is rejected
+  TEST_ASSERT_FALSE(layoutDashboard.addLayout(testLayout));
+}
+
+void test_client_tracking() {
+  // The test runs without a browser, so nobody is connected or closed
+  TEST_ASSERT_EQUAL_INT(0, dashboard.getClientCount());
+  dashboard.setClientBudget(DASHBOARD_CLIENT_BUDGET);
+  dashboard.update();
+
+  const DashboardStats& stats = dashboard.getStats();
+  TEST_ASSERT_EQUAL_UINT32(0, stats.clientsTimedOut);
+  TEST_ASSERT_EQUAL_UINT32(0, stats.clientsEvicted);
+}
+
+void test_state_revision() {
+  // Every change moves the revision that /api/state uses as its ETag;
+  // an unchanged value leaves it, so pollers get a 304
+  dashboard.updateValue("test_slider", 11);
+  uint32_t revision = dashboard.getRevision();
+  dashboard.updateValue("test_slider", 11);
+  TEST_ASSERT_EQUAL_UINT32(revision, dashboard.getRevision());
+  dashboard.updateValue("test_slider", 12);
+  TEST_ASSERT_EQUAL_UINT32(revision + 1, dashboard.getRevision());
+  dashboard.setMachineState("REVISED");
+  TEST_ASSERT_EQUAL_UINT32(revision + 2, dashboard.getRevision());
+  dashboard.addTextInput("revision_text", "Revision", "");
+  TEST_ASSERT_TRUE(dashboard.getRevision() > revision + 2);
+  TEST_ASSERT_TRUE(dashboard.removeComponent("revision_text"));
+
+  // update() serializes no snapshots until someone polls /api/state
+  dashboard.update();
+  TEST_ASSERT_EQUAL_UINT32(0, dashboard.getStats().stateSnapshots);
+}
+
 void test_machine_state() {
   dashboard.setMachineState("RUNNING");
   // This test would need a way to verify the state was set correctly
@@ -90,7 +585,26 @@ void setup() {
   RUN_TEST(test_dashboard_initialization);
   RUN_TEST(test_component_creation);
   RUN_TEST(test_update_values);
+  RUN_TEST(test_handle_updates);
+  RUN_TEST(test_bind_values);
+  RUN_TEST(test_skip_unchanged);
+  RUN_TEST(test_unwatched_updates);
   RUN_TEST(test_logging);
+  RUN_TEST(test_message_priorities);
+  RUN_TEST(test_message_parser);
+  RUN_TEST(test_rpc_calls);
+  RUN_TEST(test_event_stream);
+  RUN_TEST(test_batch_updates);
+  RUN_TEST(test_frame_pool);
+  RUN_TEST(test_shared_frames);
+  RUN_TEST(test_socket_buffers);
+  RUN_TEST(test_memory_usage);
+  RUN_TEST(test_custom_capacity);
+  RUN_TEST(test_component_growth);
+  RUN_TEST(test_remove_component);
+  RUN_TEST(test_layout);
+  RUN_TEST(test_client_tracking);
+  RUN_TEST(test_state_revision);
   RUN_TEST(test_machine_state);
 
   // End unit tests